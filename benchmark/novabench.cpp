@@ -0,0 +1,496 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include <QtGlobal>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaObject>
+#include <QThread>
+#include <QTextStream>
+#include <QApplication>
+#include <QAction>
+#include <QKeySequence>
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QTreeWidget>
+
+#include <workbench.h>
+#include <actionprovider.h>
+#include <searchbar.h>
+#include <settings.h>
+#include <settingsstore.h>
+#include <progress.h>
+#include <notification.h>
+#include <registrationqueue.h>
+#include <idlequeue.h>
+#include <shortcutdispatcher.h>
+#include <searchcontributor.h>
+
+/*
+ * Benchmarks of Nova's hot paths. They run headless (offscreen platform) and print the results as JSON, e.g.:
+ *
+ *   NovaBenchmark [--filter <substring>] [--output <file>]
+ *
+ * Times are in nanoseconds per iteration.
+ */
+
+nova::SettingsStore* settings_store;
+
+// Settings pages with 50 settings each
+class BenchSettingsPage : public nova::SettingsPage {
+	public:
+		inline explicit BenchSettingsPage(QObject* parent):
+				BenchSettingsPage(parent, page_counter++) {}
+		
+		QList<QLineEdit*> edits;
+	
+	private:
+		static int page_counter;
+		
+		inline BenchSettingsPage(QObject* parent, int page_index):
+				nova::SettingsPage(parent, QString("Page %1").arg(page_index)) {
+			auto* root_widget = new QWidget();
+			auto* layout = new QVBoxLayout(root_widget);
+			
+			for (int i = 0 ; i < 50 ; ++i) {
+				auto* edit = new QLineEdit(root_widget);
+				edit->setProperty("nova/setting", QString("Setting %1 of page %2").arg(i).arg(page_index));
+				layout->addWidget(edit);
+				edits << edit;
+			}
+			
+			set_content_widget(root_widget);
+			set_settings_store(settings_store);
+			
+			for (int i = 0 ; i < edits.count() ; ++i) {
+				BindSetting(edits[i], QString("bench/page_%1/setting_%2").arg(page_index).arg(i), QString());
+			}
+		}
+};
+
+int BenchSettingsPage::page_counter = 0;
+
+// Reports its results immediately
+class BenchFastContributor : public nova::SearchContributor {
+	public:
+		inline BenchFastContributor():
+				nova::SearchContributor("Bench Fast") {}
+	
+	protected:
+		inline void Search(nova::SearchQuery& query) override {
+			for (int i = 0 ; i < 1000 ; ++i) {
+				const QString text = QString("Result %1").arg(i);
+				const double score = query.Rate(text);
+				if (score > 0) query.Report({text, QString(), QString(), QString(), score, nullptr});
+			}
+		}
+};
+
+// Takes longer than the fast contributor's whole search
+class BenchSlowContributor : public nova::SearchContributor {
+	public:
+		inline BenchSlowContributor():
+				nova::SearchContributor("Bench Slow") {}
+	
+	protected:
+		inline void Search(nova::SearchQuery& query) override {
+			QThread::msleep(50);
+			query.Report({"Result 1 (slow)", QString(), QString(), QString(), query.Rate("Result 1 (slow)"), nullptr});
+		}
+};
+
+class BenchWorkbench : public nova::Workbench {
+	public:
+		inline BenchWorkbench():
+				nova::Workbench() {
+			set_dialog_prewarming(false);
+			
+			ConstructMenu(Workbench::Menu_File, true);
+			ConstructMenu(Workbench::Menu_Edit, true);
+			ConstructMenu(Workbench::Menu_Window);
+			ConstructStandardAction(Workbench::Action_SearchBar, get_standard_menu(Workbench::Menu_Window));
+			
+			for (int i = 0 ; i < 20 ; ++i) {
+				pages << RegisterSettingsPage<BenchSettingsPage>();
+			}
+		}
+		
+		QList<BenchSettingsPage*> pages;
+};
+
+struct BenchmarkResult {
+	QString name;
+	int iterations;
+	qint64 min;
+	qint64 median;
+	qint64 mean;
+	qint64 max;
+};
+
+QList<BenchmarkResult> results;
+QString filter;
+
+// Runs the body once for warming up and measures the following iterations
+void Benchmark(const QString& name, int iterations, const std::function<void()>& body) {
+	if (!filter.isEmpty() && !name.contains(filter)) return;
+	
+	body();
+	
+	std::vector<qint64> times;
+	times.reserve(iterations);
+	
+	QElapsedTimer timer;
+	for (int i = 0 ; i < iterations ; ++i) {
+		timer.start();
+		body();
+		times.push_back(timer.nsecsElapsed());
+	}
+	
+	std::sort(times.begin(), times.end());
+	qint64 sum = 0;
+	for (qint64 i : times) sum += i;
+	
+	results << BenchmarkResult{name, iterations, times.front(), times[times.size() / 2],
+	                           sum / static_cast<qint64>(times.size()), times.back()};
+	QTextStream(stderr) << name << ": " << (times[times.size() / 2] / 1000) << " us\n";
+}
+
+void ProcessAllEvents() {
+	QCoreApplication::sendPostedEvents();
+	QCoreApplication::processEvents();
+}
+
+void BenchmarkSearchBar(BenchWorkbench* window) {
+	for (int count : {1000, 10000, 100000}) {
+		nova::ActionProvider provider(QString("Bench %1").arg(count));
+		for (int i = 0 ; i < count ; ++i) {
+			provider.ConstructAction(QString("Action %1").arg(i));
+		}
+		window->RegisterActionProvider(&provider);
+		
+		nova::SearchBar bar(window);
+		auto* line_edit = bar.findChild<QLineEdit*>();
+		
+		// suggest() is a private slot
+		Benchmark(QString("search_bar/suggest/%1").arg(count), 20, [&bar, line_edit]() {
+			for (const char* i : {"a", "ac", "action 1", "action 12", "action 123"}) {
+				line_edit->setText(i);
+				QMetaObject::invokeMethod(&bar, "suggest");
+			}
+		});
+		
+		window->UnregisterActionProvider(&provider);
+	}
+}
+
+void BenchmarkSearchContributors(BenchWorkbench* window) {
+	BenchFastContributor fast_contributor;
+	BenchSlowContributor slow_contributor;
+	window->RegisterSearchContributor(&fast_contributor);
+	window->RegisterSearchContributor(&slow_contributor);
+	
+	nova::SearchBar bar(window);
+	auto* line_edit = bar.findChild<QLineEdit*>();
+	auto* tree = bar.findChild<QTreeWidget*>();
+	
+	// Until the fast contributor's 111 results are merged into the top 100, the slow one is still searching
+	Benchmark("search_bar/contributors/first_results", 20, [&bar, line_edit, tree]() {
+		line_edit->setText("result 1");
+		QMetaObject::invokeMethod(&bar, "suggest");
+		
+		while (tree->topLevelItemCount() < 100) {
+			QCoreApplication::processEvents();
+		}
+	});
+	
+	window->UnregisterSearchContributor(&slow_contributor);
+	window->UnregisterSearchContributor(&fast_contributor);
+}
+
+void BenchmarkActionGroups() {
+	Benchmark("action_group/append_to_shown_group/1000", 50, []() {
+		nova::ActionProvider provider("Bench");
+		auto* group = new nova::ActionGroup();
+		provider.ShowActionGroup(group);
+		for (int i = 0 ; i < 1000 ; ++i) {
+			group->AddAction(provider.ConstructAction(QString("Action %1").arg(i)));
+		}
+	});
+	
+	Benchmark("action_group/show_groups/1000", 50, []() {
+		nova::ActionProvider provider("Bench");
+		for (int i = 0 ; i < 1000 ; ++i) {
+			provider.ShowAction(provider.ConstructAction(QString("Action %1").arg(i)));
+		}
+	});
+	
+	Benchmark("action_group/interleaved/10x100", 50, []() {
+		nova::ActionProvider provider("Bench");
+		QList<nova::ActionGroup*> groups;
+		for (int i = 0 ; i < 10 ; ++i) {
+			groups << provider.ShowActionGroup(new nova::ActionGroup());
+		}
+		
+		// Inserting into the first groups shifts the indices of all following ones
+		for (int i = 0 ; i < 1000 ; ++i) {
+			groups[i % groups.count()]->AddAction(provider.ConstructAction(QString("Action %1").arg(i)),
+			                                      (i % 3) == 0);
+		}
+	});
+}
+
+void BenchmarkSettings(BenchWorkbench* window) {
+	nova::Properties parameters;
+	parameters["workbench"] = reinterpret_cast<quintptr>(window);
+	
+	Benchmark("settings_page/recreate_actions/50", 100, [window, &parameters]() {
+		window->pages[0]->InvalidateActions();
+		window->pages[0]->RecreateActions(parameters);
+	});
+	
+	Benchmark("settings_page/recreate_actions_unchanged/50", 100, [window, &parameters]() {
+		window->pages[0]->RecreateActions(parameters);
+	});
+	
+	Benchmark("settings_dialog/open/20x50", 20, [window]() {
+		nova::SettingsDialog dialog(window);
+		dialog.show();
+		ProcessAllEvents();
+		dialog.hide();
+	});
+	
+	{
+		nova::SettingsDialog dialog(window);
+		dialog.show();
+		ProcessAllEvents();
+		
+		// The filter is a private slot, it's called for each keystroke
+		Benchmark("settings_dialog/filter/20x50", 50, [&dialog]() {
+			for (const char* i : {"s", "se", "set", "setting 1", "setting 12", "page 1", "*of page 1*", ""}) {
+				QMetaObject::invokeMethod(&dialog, "lneFilterTextChanged", Q_ARG(QString, QString(i)));
+			}
+		});
+		
+		int counter = 0;
+		Benchmark("settings_dialog/apply/20x50", 50, [&dialog, window, &counter]() {
+			for (BenchSettingsPage* i : window->pages) {
+				i->edits[counter % i->edits.count()]->setText(QString::number(counter));
+			}
+			counter++;
+			
+			QMetaObject::invokeMethod(&dialog, "apply");
+		});
+		
+		dialog.hide();
+	}
+}
+
+void BenchmarkTasks(BenchWorkbench* window) {
+	Benchmark("task/throughput/100", 10, [window]() {
+		std::atomic<int> finished_tasks(0);
+		for (int i = 0 ; i < 100 ; ++i) {
+			auto* task = new nova::Task(window, "Bench", true, [](nova::Task*) -> nova::TaskResult {
+				return nova::TaskResult(true, nullptr);
+			});
+			QObject::connect(task, &QThread::finished, [&finished_tasks]() { finished_tasks++; });
+			task->start();
+		}
+		
+		// Includes enabling and disabling the tasks on the GUI thread
+		while (finished_tasks < 100) ProcessAllEvents();
+		ProcessAllEvents();
+	});
+	
+	Benchmark("task/progress_flooding/10000", 10, [window]() {
+		std::atomic<bool> is_finished(false);
+		auto* task = new nova::Task(window, "Bench", false, [](nova::Task* task) -> nova::TaskResult {
+			for (int i = 0 ; i < 10000 ; ++i) {
+				task->set_value(i % 101);
+			}
+			return nova::TaskResult(true, nullptr);
+		});
+		QObject::connect(task, &QThread::finished, [&is_finished]() { is_finished = true; });
+		task->start();
+		
+		// Includes processing the queued updates on the GUI thread
+		while (!is_finished) ProcessAllEvents();
+		ProcessAllEvents();
+	});
+}
+
+void BenchmarkNotifications(BenchWorkbench* window) {
+	Benchmark("notification/burst/1000", 20, [window]() {
+		for (int i = 0 ; i < 1000 ; ++i) {
+			window->ShowNotification("Bench", QString("Notification %1").arg(i));
+		}
+		ProcessAllEvents();
+	});
+	
+	QTextStream(stderr) << "avoided view updates: " << window->get_avoided_view_updates() << "\n";
+}
+
+void BenchmarkRegistrationQueue(BenchWorkbench* window) {
+	nova::RegistrationQueue* queue = window->get_registration_queue();
+	
+	Benchmark("registration_queue/stage_and_commit/4x2500", 10, [queue]() {
+		QList<QThread*> threads;
+		for (int i = 0 ; i < 4 ; ++i) {
+			threads << QThread::create([queue, i]() {
+				const QString provider = QString("Bench Queue %1").arg(i);
+				const int group = queue->StageGroup(provider);
+				for (int j = 0 ; j < 2500 ; ++j) {
+					nova::ActionDescription action;
+					action.text = QString("Action %1").arg(j);
+					queue->StageAction(provider, group, action);
+				}
+			});
+			threads.last()->start();
+		}
+		
+		for (QThread* i : threads) {
+			i->wait();
+			delete i;
+		}
+		queue->Commit();
+	});
+}
+
+void BenchmarkIdleQueue(BenchWorkbench* window) {
+	nova::IdleQueue* queue = window->get_idle_queue();
+	queue->ResetMetrics();
+	
+	// Every 10th post replaces a pending job
+	Benchmark("idle_queue/post_and_run/10000", 10, [queue]() {
+		int counter = 0;
+		for (int i = 0 ; i < 10000 ; ++i) {
+			queue->Post([&counter]() { ++counter; }, i % 3, QString("bench/%1").arg(i % 9000));
+		}
+		
+		while (queue->get_pending_count() > 0) {
+			QCoreApplication::processEvents();
+		}
+	});
+	
+	const nova::IdleQueueMetrics metrics = queue->get_metrics();
+	QTextStream(stderr) << "idle queue: mean latency " << metrics.mean_latency << " ns, max slice "
+	                    << metrics.max_slice_duration << " ns\n";
+}
+
+void BenchmarkShortcuts(BenchWorkbench* window) {
+	nova::ShortcutDispatcher* dispatcher = window->get_shortcut_dispatcher();
+	
+	// Distinct sequences like "Ctrl+A, Ctrl+B, Alt+C"
+	nova::ActionProvider provider("Bench Shortcuts");
+	window->RegisterActionProvider(&provider);
+	
+	QList<QKeySequence> sequences;
+	for (int i = 0 ; i < 10000 ; ++i) {
+		sequences << QKeySequence(Qt::CTRL | (Qt::Key_A + i % 26), Qt::CTRL | (Qt::Key_A + i / 26 % 26),
+		                          Qt::ALT | (Qt::Key_A + i / 676 % 26));
+		provider.ConstructAction(QString("Action %1").arg(i))->setShortcut(sequences.last());
+	}
+	
+	Benchmark("shortcut_dispatcher/find/10000", 20, [dispatcher, &sequences]() {
+		for (const QKeySequence& i : sequences) {
+			dispatcher->FindAction(i);
+		}
+	});
+	
+	// Incremental update after a shortcut change
+	QAction* action = provider.ListActions().first();
+	int counter = 0;
+	Benchmark("shortcut_dispatcher/change_one/10000", 100, [dispatcher, action, &counter]() {
+		action->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | (Qt::Key_A + counter++ % 26)));
+		dispatcher->FindAction(action->shortcut());
+	});
+	
+	window->UnregisterActionProvider(&provider);
+}
+
+void BenchmarkStartup() {
+	Benchmark("workbench/startup", 10, []() {
+		BenchWorkbench window;
+		window.show();
+		ProcessAllEvents();
+	});
+}
+
+int main(int argc, char** argv) {
+	// Headless, unless another platform is explicitly requested
+	if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+	
+	QApplication application(argc, argv);
+	
+	QString output;
+	const QStringList arguments = QApplication::arguments();
+	for (int i = 1 ; i < arguments.count() - 1 ; ++i) {
+		if (arguments[i] == "--filter") filter = arguments[i + 1];
+		else if (arguments[i] == "--output") output = arguments[i + 1];
+	}
+	
+	QTemporaryDir directory;
+	settings_store = new nova::SettingsStore(directory.filePath("settings.ini"), QSettings::IniFormat, &application);
+	
+	BenchmarkActionGroups();
+	BenchmarkStartup();
+	
+	{
+		BenchWorkbench window;
+		window.show();
+		ProcessAllEvents();
+		
+		BenchmarkSearchBar(&window);
+		BenchmarkSearchContributors(&window);
+		BenchmarkSettings(&window);
+		BenchmarkTasks(&window);
+		BenchmarkNotifications(&window);
+		BenchmarkRegistrationQueue(&window);
+		BenchmarkIdleQueue(&window);
+		BenchmarkShortcuts(&window);
+	}
+	
+	settings_store->Sync();
+	
+	// Machine-readable results
+	QJsonArray benchmarks;
+	for (const BenchmarkResult& i : results) {
+		QJsonObject benchmark;
+		benchmark["name"] = i.name;
+		benchmark["iterations"] = i.iterations;
+		benchmark["min_ns"] = static_cast<double>(i.min);
+		benchmark["median_ns"] = static_cast<double>(i.median);
+		benchmark["mean_ns"] = static_cast<double>(i.mean);
+		benchmark["max_ns"] = static_cast<double>(i.max);
+		benchmarks.append(benchmark);
+	}
+	
+	QJsonObject root;
+	root["qt_version"] = QString(qVersion());
+	root["benchmarks"] = benchmarks;
+	const QByteArray json = QJsonDocument(root).toJson();
+	
+	if (output.isEmpty()) {
+		QTextStream(stdout) << json;
+	} else {
+		QFile file(output);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || (file.write(json) != json.size())) return 1;
+	}
+	
+	return 0;
+}
@@ -6,11 +6,15 @@
 #ifndef NOVA_FRAMEWORK_ACTIONPROVIDER_H
 #define NOVA_FRAMEWORK_ACTIONPROVIDER_H
 
+#include <atomic>
+#include <functional>
+
 #include <Qt>
 #include <QObject>
 #include <QString>
 #include <QVariant>
 #include <QList>
+#include <QHash>
 #include <QMap>
 #include <QMenu>
 #include <QAction>
@@ -46,7 +50,7 @@ namespace nova {
 			 * the group and extend it using nova::ActionProvider::FindGroup().
 			 * (optional, default: a negative number is used to avoid conflicts with custom ids)
 			 */
-			explicit ActionGroup(int id = --id_counter);  // Positive ids are reserved for users
+			explicit ActionGroup(int id = GenerateId());  // Positive ids are reserved for users
 			
 			/**
 			 * @brief Creates a group with an action.
@@ -90,6 +94,35 @@ namespace nova {
 			 */
 			void AddMenu(MenuActionProvider* menu);
 			
+			/**
+			 * @brief Removes an action from the group.
+			 *
+			 * If the group is already shown, the action is hidden and the positions of the following groups are updated.
+			 * The action isn't deleted.
+			 *
+			 * @param action The action to be removed
+			 * @return False if the action doesn't belong to the group
+			 */
+			bool RemoveAction(QAction* action);
+			
+			/**
+			 * @brief Returns the group's actions in their order.
+			 */
+			inline QList<QAction*> ListActions() const { return actions; }
+			
+			/**
+			 * @brief Sets a function which updates the state of the group's actions (e.g. enabled, checked, visible)
+			 * from the application's context.
+			 *
+			 * The function is called once immediately. Afterwards, it's called with the provider's other update
+			 * functions (see nova::ActionProvider::UpdateActions()).
+			 *
+			 * @param callback The update function (an empty function removes it)
+			 *
+			 * @sa nova::ActionProvider::SetUpdateCallback() for single actions
+			 */
+			void SetUpdateCallback(const std::function<void(ActionGroup*)>& callback);
+			
 			/**
 			 * @brief Returns the identification number of the group.
 			 *
@@ -103,18 +136,28 @@ namespace nova {
 			 * @sa nova::ActionProvider::ShowActionGroup() to associate a provider
 			 */
 			inline ActionProvider* get_provider() const { return provider; }
+			
+			/**
+			 * @brief Returns a new negative identification number, which is unique within the application.
+			 *
+			 * This method is thread-safe.
+			 */
+			inline static int GenerateId() { return --id_counter; }
 		
 		private:
 			friend class ActionProvider;
 			
-			static int id_counter;
+			static std::atomic<int> id_counter;
 			
 			int id;
 			int num_shown;
 			bool has_important_action;
 			bool important_action_shown;
+			bool has_separator;
+			bool has_important_separator;
 			QList<QAction*> actions;
 			QList<bool> important_list;
+			std::function<void(ActionGroup*)> update_callback;
 			
 			ActionProvider* provider;
 			int my_index;
@@ -148,7 +191,7 @@ namespace nova {
 			/**
 			 * @brief Constructs an action which is bound to this provider.
 			 *
-			 * The action is deleted when the provider gets deleted.
+			 * The action is deleted when the provider gets deleted. Its uses are recorded by nova::UsageStore.
 			 *
 			 * @param text The action's title (can contain the hotkey character "&")
 			 * @return A pointer to the constructed action
@@ -158,12 +201,12 @@ namespace nova {
 			/**
 			 * @brief Adds an action which wasn't constructed using ConstructAction() to the provider's list.
 			 *
-			 * The action's parent will be manipulated.
+			 * The action's parent will be manipulated. Its uses are recorded by nova::UsageStore.
 			 *
 			 * @param action The action to be migrated
 			 * @sa ConstructAction()
 			 */
-			inline void MigrateAction(QAction* action) { action->setParent(&object); }
+			void MigrateAction(QAction* action);
 			
 			/**
 			 * @brief Returns a list containing all actions which belong to this provider.
@@ -235,6 +278,59 @@ namespace nova {
 			 */
 			ActionGroup* ShowActionGroup(ActionGroup* group);
 			
+			/**
+			 * @brief Hides a group including its separators and deletes it.
+			 *
+			 * The group's actions aren't deleted. The positions of the following groups are updated.
+			 *
+			 * @param group The group to be removed, it must belong to this provider
+			 *
+			 * @sa ShowActionGroup()
+			 */
+			void RemoveActionGroup(ActionGroup* group);
+			
+			/**
+			 * @brief Sets a function which updates the state of an action (e.g. enabled, checked, visible) from the
+			 * application's context.
+			 *
+			 * Instead of reacting to each change of the context, the application calls
+			 * nova::Workbench::InvalidateActionStates(). The update functions are called once immediately and afterwards
+			 * in one batch (see UpdateActions()), so that menus and tool bars are updated at most once per change.
+			 *
+			 * @param action The action, it should belong to this provider
+			 * @param callback The update function (an empty function removes it)
+			 *
+			 * @sa nova::ActionGroup::SetUpdateCallback() for whole groups
+			 */
+			void SetUpdateCallback(QAction* action, const std::function<void(QAction*)>& callback);
+			
+			/**
+			 * @brief Calls the update functions of the provider's groups and actions if the context has been
+			 * invalidated since the last update.
+			 *
+			 * Usually, there is no need to call this method. It's called when the provider is displayed (e.g. a menu is
+			 * opened), when nova::SearchBar lists its actions and after an invalidation while it's displayed.
+			 *
+			 * @sa SetUpdateCallback()
+			 * @sa nova::Workbench::InvalidateActionStates()
+			 */
+			void UpdateActions();
+			
+			/**
+			 * @brief Marks the state of the provider's actions as outdated, so that the next call of UpdateActions()
+			 * calls the update functions.
+			 *
+			 * @sa nova::Workbench::InvalidateActionStates() to invalidate all providers
+			 */
+			inline void InvalidateActionStates() { are_actions_outdated = true; }
+			
+			/**
+			 * @brief Returns true if the provider currently displays its actions (e.g. a visible menu or tool bar).
+			 *
+			 * The default implementation returns false, so that the actions are only updated when they are searched.
+			 */
+			inline virtual bool is_displayed() const { return false; }
+			
 			/**
 			 * @brief Changes the title of the provider.
 			 *
@@ -287,16 +383,41 @@ namespace nova {
 			 */
 			inline virtual void DisplaySeparators(bool show_regular, int index_regular,
 			                                      bool show_important_actions, int index_important_actions) {}
+			
+			/**
+			 * @brief Your implementation should stop displaying a range of actions and separators.
+			 *
+			 * The method's default implementation does nothing.
+			 *
+			 * @param index The position of the first action or separator to be hidden
+			 * @param count The count of actions and separators to be hidden
+			 * @param important_actions_index The position in the additional container for important actions
+			 * @param important_count The count of actions and separators to be hidden in the additional container
+			 *
+			 * @sa DisplayAction()
+			 * @sa DisplaySeparators()
+			 */
+			inline virtual void HideActions(int index, int count, int important_actions_index, int important_count) {}
 		
 		private:
+			friend class Workbench;
 			friend class ActionGroup;
+			friend class ShortcutDispatcher;
 			
 			QString title;
 			QObject object;  // For the actions to be deleted
+			Workbench* owner;  // The workbench the provider is registered at, which records the uses
 			
 			QList<ActionGroup*> groups;
 			int max_index;
 			int max_index_important;
+			
+			QHash<QAction*, std::function<void(QAction*)>> update_callbacks;
+			bool are_actions_outdated;
+			
+			// Moves the groups beginning with first_group
+			void ShiftGroups(int first_group, int offset, int important_offset);
+			void TrackUses(QAction* action);
 	};
 	
 	/**
@@ -406,6 +527,13 @@ namespace nova {
 			 * This method is internally required and should not be called.
 			 */
 			inline void set_title(const QString&) override {}
+			
+			/**
+			 * @brief Returns true if the menu or its tool bar is visible.
+			 *
+			 * This method is internally required and should not be called.
+			 */
+			bool is_displayed() const override;
 		
 		protected:
 			/**
@@ -420,6 +548,11 @@ namespace nova {
 			 */
 			void DisplaySeparators(bool show_regular, int index_regular,
 			                       bool show_important_actions, int index_important_actions) override;
+			
+			/**
+			 * This method is internally required and should not be called.
+			 */
+			void HideActions(int index, int count, int important_actions_index, int important_count) override;
 		
 		private:
 			friend class Workbench;
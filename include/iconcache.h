@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#ifndef NOVA_FRAMEWORK_ICONCACHE_H
+#define NOVA_FRAMEWORK_ICONCACHE_H
+
+#include <QSize>
+#include <QIcon>
+#include <QPixmap>
+#include <QStyle>
+
+#include "nova.h"
+
+namespace nova {
+	/**
+	 * @brief A shared cache for the small icons being rendered again and again by Nova.
+	 * @headerfile iconcache.h <nova/iconcache.h>
+	 *
+	 * Pixmaps are cached per icon, size, device pixel ratio and mode. The memory is bounded, the least recently
+	 * used pixmaps are removed first.
+	 *
+	 * Nova uses the cache for the notification bar, the taskbar, the search results and the standard icons of
+	 * notifications. The cache must only be used from the GUI thread.
+	 */
+	class NOVA_API IconCache {
+		public:
+			IconCache() = delete;
+			
+			/**
+			 * @brief Returns the icon rendered in the given size for the application's device pixel ratio.
+			 *
+			 * @param icon The icon to be rendered
+			 * @param size The size in device-independent pixels
+			 * @param mode The icon's mode (optional, default: QIcon::Normal)
+			 */
+			static QPixmap Pixmap(const QIcon& icon, const QSize& size, QIcon::Mode mode = QIcon::Normal);
+			
+			/**
+			 * @brief Returns an icon which only contains the cached pixmap in the given size.
+			 *
+			 * Views displaying the returned icon in this size don't have to render it again. All copies share
+			 * the same pixmap.
+			 *
+			 * @param icon The original icon
+			 * @param size The size in device-independent pixels the icon is displayed with
+			 */
+			static QIcon Icon(const QIcon& icon, const QSize& size);
+			
+			/**
+			 * @brief Returns a standard icon of the application's style.
+			 *
+			 * The icon is only requested once from the style.
+			 */
+			static QIcon StandardIcon(QStyle::StandardPixmap standard_pixmap);
+			
+			/**
+			 * @brief Returns the maximum memory in kilobytes the cached pixmaps may use.
+			 */
+			static int get_max_cost();
+			
+			/**
+			 * @brief Sets the maximum memory in kilobytes the cached pixmaps may use (default: 2048).
+			 */
+			static void set_max_cost(int kilobytes);
+			
+			/**
+			 * @brief Removes all cached pixmaps and icons, e.g. after the application's style changed.
+			 */
+			static void Clear();
+	};
+}
+
+#endif  // NOVA_FRAMEWORK_ICONCACHE_H
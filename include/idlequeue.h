@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#ifndef NOVA_FRAMEWORK_IDLEQUEUE_H
+#define NOVA_FRAMEWORK_IDLEQUEUE_H
+
+#include <functional>
+#include <map>
+#include <utility>
+
+#include <QtGlobal>
+#include <QString>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "nova.h"
+
+namespace nova {
+	/**
+	 * @brief Statistics of a nova::IdleQueue.
+	 * @headerfile idlequeue.h <nova/idlequeue.h>
+	 *
+	 * Times are measured in nanoseconds. The latency is the time between posting and running a job.
+	 */
+	struct NOVA_API IdleQueueMetrics {
+		//! The count of jobs being run
+		quint64 run_count = 0;
+		//! The count of jobs being cancelled
+		quint64 cancelled_count = 0;
+		//! The count of jobs which replaced a pending job with the same key
+		quint64 deduplicated_count = 0;
+		//! The average latency of the jobs being run
+		qint64 mean_latency = 0;
+		//! The maximum latency of the jobs being run
+		qint64 max_latency = 0;
+		//! The maximum time a slice blocked the event loop
+		qint64 max_slice_duration = 0;
+	};
+	
+	/**
+	 * @brief Runs jobs which aren't urgent on the GUI thread while the event loop is idle.
+	 * @headerfile idlequeue.h <nova/idlequeue.h>
+	 *
+	 * Jobs are run when all pending events have been processed. Each slice runs jobs until the frame budget
+	 * (see set_frame_budget()) is exhausted, then input and paint events are processed again. So, background work
+	 * doesn't cause input lag as long as each job is short.
+	 *
+	 * Jobs with a higher priority are run first, jobs with the same priority in the order they are posted.
+	 * A job posted with the key of a pending job replaces it (the pending job isn't run). Nova uses keys beginning
+	 * with "nova/".
+	 *
+	 * The queue must only be used on the GUI thread.
+	 *
+	 * @sa nova::Workbench::get_idle_queue()
+	 */
+	class NOVA_API IdleQueue {
+		public:
+			/**
+			 * @brief Creates a new nova::IdleQueue.
+			 *
+			 * Usually, there is no need to create one, use nova::Workbench::get_idle_queue() instead.
+			 */
+			IdleQueue();
+			NOVA_DISABLE_COPY(IdleQueue)
+			
+			/**
+			 * @brief Queues a job.
+			 *
+			 * If there's a pending job with the same key, its function and priority are replaced, but it keeps
+			 * its id and its latency is measured from the first post.
+			 *
+			 * @param job The function to be run
+			 * @param priority Jobs with a higher priority are run first (optional, default: 0)
+			 * @param key The key deduplicating the job (optional, default: none)
+			 * @return The job's id, e.g. to cancel it
+			 */
+			int Post(const std::function<void()>& job, int priority = 0, const QString& key = QString());
+			
+			/**
+			 * @brief Removes a pending job.
+			 *
+			 * @return False if there's no pending job with this id
+			 */
+			bool Cancel(int id);
+			
+			/**
+			 * @brief Removes the pending job with the given key.
+			 *
+			 * @return False if there's no pending job with this key
+			 */
+			bool Cancel(const QString& key);
+			
+			/**
+			 * @brief Runs the pending job with the given key immediately, e.g. because its result is needed now.
+			 *
+			 * @return False if there's no pending job with this key
+			 */
+			bool Flush(const QString& key);
+			
+			/**
+			 * @brief Removes all pending jobs.
+			 */
+			void Clear();
+			
+			/**
+			 * @brief Returns true if there's a pending job with this key.
+			 */
+			inline bool is_pending(const QString& key) const { return keys.contains(key); }
+			
+			/**
+			 * @brief Returns the count of pending jobs.
+			 */
+			inline int get_pending_count() const { return static_cast<int>(jobs.size()); }
+			
+			/**
+			 * @brief Returns the time in milliseconds a slice may run jobs.
+			 */
+			inline int get_frame_budget() const { return frame_budget; }
+			
+			/**
+			 * @brief Sets the time in milliseconds a slice may run jobs (default: 4).
+			 *
+			 * At least one job is run per slice.
+			 */
+			inline void set_frame_budget(int frame_budget) { this->frame_budget = frame_budget; }
+			
+			/**
+			 * @brief Returns the statistics collected since the queue was created or reset.
+			 */
+			inline IdleQueueMetrics get_metrics() const { return metrics; }
+			
+			/**
+			 * @brief Resets the statistics.
+			 */
+			void ResetMetrics();
+		
+		private:
+			struct Job {
+				int id;
+				QString key;
+				std::function<void()> function;
+				qint64 post_time;
+			};
+			
+			// Sorted by priority (negated) and sequence
+			typedef std::pair<int, quint64> Position;
+			
+			std::map<Position, Job> jobs;
+			QHash<int, Position> positions;
+			QHash<QString, int> keys;
+			quint64 sequence;
+			int id_counter;
+			
+			int frame_budget;
+			QTimer timer;
+			QElapsedTimer clock;
+			
+			IdleQueueMetrics metrics;
+			qint64 total_latency;
+			
+			void Run(std::map<Position, Job>::iterator iterator);
+			void RunSlice();
+	};
+}
+
+#endif  // NOVA_FRAMEWORK_IDLEQUEUE_H
@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#ifndef NOVA_FRAMEWORK_PLUGIN_H
+#define NOVA_FRAMEWORK_PLUGIN_H
+
+#include <QtPlugin>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <QPointer>
+#include <QJsonObject>
+#include <QThreadPool>
+#include <QAction>
+
+#include "nova.h"
+
+class QPluginLoader;
+class QWidget;
+
+namespace nova {
+	class ActionProvider;
+	class ActionGroup;
+	class ToolWindow;
+	class ToolWindowPlaceholder;
+	class SettingsPage;
+	class SearchContributor;
+	
+	/**
+	 * @brief The interface every Nova plugin implements.
+	 * @headerfile plugin.h <nova/plugin.h>
+	 *
+	 * A plugin is a Qt plugin (shared library) whose root object implements this interface:
+	 *
+	 * @code
+	 * class MyPlugin : public QObject, public nova::Plugin {
+	 *     Q_OBJECT
+	 *     Q_PLUGIN_METADATA(IID NOVA_PLUGIN_IID)
+	 *     Q_INTERFACES(nova::Plugin)
+	 *
+	 *     public:
+	 *         bool Initialize() override { ... }  // Worker thread
+	 *         void Activate(nova::Workbench* window) override { window->RegisterToolWindow<MyToolWindow>(); }
+	 * };
+	 * @endcode
+	 *
+	 * Next to the library, a manifest (JSON file) describes the plugin, so that it can be discovered
+	 * without loading the library:
+	 *
+	 * @code
+	 * {
+	 *     "name": "My Plugin",
+	 *     "library": "myplugin",
+	 *     "dependencies": ["Other Plugin"],
+	 *     "lazy": true,
+	 *     "actions": [
+	 *         {
+	 *             "id": "myplugin.open",
+	 *             "text": "&Open My Tool",
+	 *             "tooltip": "Opens my tool",
+	 *             "shortcut": "Ctrl+Shift+M",
+	 *             "icon": ":/myplugin/open.png",
+	 *             "provider": "menu:window",
+	 *             "group": 42
+	 *         }
+	 *     ]
+	 * }
+	 * @endcode
+	 *
+	 * "library" is relative to the manifest's directory, the platform's suffix can be omitted.
+	 * Lazy plugins are only loaded when they are activated explicitly (nova::PluginManager::ActivatePlugin()),
+	 * when another plugin depends on them or when one of their declared actions is triggered.
+	 *
+	 * The declared actions are constructed without loading the library, so that they appear in menus and
+	 * nova::SearchBar right away. "provider" is either a standard menu ("menu:file", "menu:edit", "menu:window",
+	 * "menu:help") or the title of a registered action provider (without "&"). If "group" is the id of an
+	 * existing group of this provider, the action is added to it. Otherwise, the action gets its own group.
+	 * Actions without a (known) provider are only listed in nova::SearchBar. "icon" is a file or resource path,
+	 * theme icons are prefixed with "theme:".
+	 *
+	 * The plugin connects to its declared actions in Activate() using nova::PluginManager::get_action().
+	 * If triggering an action loads the plugin, the plugin is initialized in the background and the action is
+	 * triggered again after activation.
+	 *
+	 * @sa nova::PluginManager
+	 */
+	class NOVA_API Plugin {
+		public:
+			virtual ~Plugin() noexcept = default;
+			
+			/**
+			 * @brief Prepares the plugin, e.g. by reading files or building indices.
+			 *
+			 * This method is called on a worker thread, while independent plugins are initialized in parallel.
+			 * Therefore, no widgets may be created here. The plugins this plugin depends on are already initialized.
+			 * Actions can be staged using nova::Workbench::get_registration_queue(), they are registered right before
+			 * the plugin is activated. Only descriptions staged on this thread while this method runs belong to the
+			 * plugin and are removed when it's unloaded.
+			 *
+			 * Unless the plugin is loaded by one of its declared actions, the GUI thread waits until all plugins being
+			 * loaded together are initialized. So, expensive preparations should rather be started here and finished
+			 * in the background (e.g. by a nova::Task).
+			 *
+			 * @return False if the plugin can't be used
+			 */
+			inline virtual bool Initialize() { return true; }
+			
+			/**
+			 * @brief Adds the plugin's contributions (tool windows, settings pages, menus, actions) to the workbench.
+			 *
+			 * This method is called on the GUI thread after Initialize().
+			 *
+			 * @param window The workbench the plugin is activated in
+			 */
+			virtual void Activate(Workbench* window) = 0;
+			
+			/**
+			 * @brief Removes contributions which nova::PluginManager can't track, before the plugin is unloaded.
+			 *
+			 * Tool windows, settings pages, status bar widgets, menus, groups and actions added in Activate() are
+			 * removed automatically afterwards. Other action providers and search contributors are only unregistered,
+			 * the plugin has to delete them (e.g. here or in its destructor). Providers, groups and actions staged by
+			 * Initialize() are removed, too.
+			 *
+			 * This method is called on the GUI thread. The default implementation does nothing.
+			 *
+			 * @param window The workbench the plugin has been activated in
+			 */
+			inline virtual void Deactivate(Workbench* window) {}
+	};
+	
+	/**
+	 * @brief Discovers, loads and activates plugins.
+	 * @headerfile plugin.h <nova/plugin.h>
+	 *
+	 * Plugins are discovered by their manifests. Independent plugins are loaded and initialized in parallel on
+	 * worker threads. Plugins which depend on other plugins are initialized after their dependencies. Afterwards,
+	 * the plugins are activated on the GUI thread in the order of their dependencies.
+	 *
+	 * Loading blocks the GUI thread until the plugins are activated. Since independent plugins are initialized in
+	 * parallel, it takes as long as the slowest chain of dependencies rather than all plugins together. Only when
+	 * a declared action of a lazy plugin is triggered, the plugin is initialized in the background and activated
+	 * afterwards. Meanwhile, the other methods wait until this activation is finished.
+	 *
+	 * Errors are reported as notifications of the workbench.
+	 *
+	 * The translations belong to the context "nova/plugin".
+	 *
+	 * @sa nova::Plugin
+	 * @sa nova::Workbench::get_plugin_manager()
+	 */
+	class NOVA_API PluginManager : public QObject {
+		Q_OBJECT
+		
+		public:
+			/**
+			 * @brief Creates a new nova::PluginManager.
+			 *
+			 * Usually, there is no need to create one, use nova::Workbench::get_plugin_manager() instead.
+			 *
+			 * @param window The workbench the plugins are activated in
+			 */
+			explicit PluginManager(Workbench* window);
+			NOVA_DISABLE_COPY(PluginManager)
+			virtual ~PluginManager() noexcept;
+			
+			/**
+			 * @brief Discovers the manifests (*.json) of a directory and loads all plugins which aren't lazy.
+			 *
+			 * The method returns after the plugins have been activated, the GUI thread is blocked meanwhile.
+			 * Use nova::Workbench::ScheduleStartupJob() to load them after the workbench has been painted.
+			 *
+			 * @param directory The directory containing the manifests
+			 * @return The count of activated plugins
+			 */
+			int LoadPlugins(const QString& directory);
+			
+			/**
+			 * @brief Loads, initializes and activates a plugin and its dependencies.
+			 *
+			 * Nothing happens if the plugin is already active. Otherwise, the GUI thread is blocked until the plugin
+			 * has been activated.
+			 *
+			 * @return False if the plugin is unknown or can't be loaded
+			 */
+			bool ActivatePlugin(const QString& name);
+			
+			/**
+			 * @brief Removes the contributions of a plugin and the plugins depending on it and unloads the libraries.
+			 *
+			 * Declared actions stay, triggering them loads the plugin again. This method must not be called by
+			 * the plugin itself.
+			 *
+			 * @return False if the plugin is unknown or isn't active
+			 *
+			 * @sa nova::Plugin::Deactivate()
+			 */
+			bool UnloadPlugin(const QString& name);
+			
+			/**
+			 * @brief Unloads a plugin and the plugins depending on it, loads the libraries again and activates them.
+			 *
+			 * This allows replacing a plugin's library while the application is running. Depending on the platform,
+			 * a library is only reloaded from disk if no other code keeps it loaded. The GUI thread is blocked until
+			 * the plugins have been activated again.
+			 *
+			 * @return False if the plugin is unknown, isn't active or can't be loaded again
+			 */
+			bool ReloadPlugin(const QString& name);
+			
+			/**
+			 * @brief Returns the names of all discovered plugins.
+			 */
+			QStringList get_plugins() const;
+			
+			/**
+			 * @brief Returns true if the plugin has been activated.
+			 */
+			bool is_active(const QString& name) const;
+			
+			/**
+			 * @brief Returns the plugin's instance or nullptr if it isn't loaded.
+			 */
+			Plugin* get_plugin(const QString& name) const;
+			
+			/**
+			 * @brief Returns the plugin's manifest.
+			 */
+			QJsonObject get_manifest(const QString& name) const;
+			
+			/**
+			 * @brief Returns an action declared by a manifest or nullptr if there's none with this id.
+			 *
+			 * @sa nova::Plugin
+			 */
+			inline QAction* get_action(const QString& id) const { return actions.value(id, nullptr); }
+		
+		private:
+			// What a plugin added to the workbench in Activate()
+			struct Contributions {
+				QList<ActionProvider*> providers;
+				QList<ToolWindow*> tool_windows;
+				QList<ToolWindowPlaceholder*> placeholders;
+				QList<SettingsPage*> settings_pages;
+				QList<QWidget*> status_bar_widgets;
+				QList<QPair<ActionProvider*, int>> groups;  // Groups added to other providers
+				QList<QPair<QPair<ActionProvider*, int>, QPointer<QAction>>> grouped_actions;  // Added to other groups
+				QList<QPointer<QAction>> actions;  // Constructed by other providers
+				QList<SearchContributor*> search_contributors;
+			};
+			
+			// A lazy plugin being initialized in the background, because its action has been triggered
+			struct BackgroundActivation {
+				PluginInfo* info;
+				QPointer<QAction> action;  // Triggered again after activation
+				QList<PluginInfo*> ordered;
+				QHash<PluginInfo*, int> levels;
+				int level_count;
+				int level;
+				int remaining;  // Plugins of the current level being initialized
+			};
+			
+			// State of the workbench before a plugin is activated
+			struct Snapshot {
+				QSet<ActionProvider*> providers;
+				QSet<ToolWindow*> tool_windows;
+				QSet<ToolWindowPlaceholder*> placeholders;
+				QSet<SettingsPage*> settings_pages;
+				QSet<QWidget*> status_bar_widgets;
+				QHash<ActionProvider*, QSet<QAction*>> actions;
+				QHash<ActionGroup*, QSet<QAction*>> grouped_actions;
+				QSet<SearchContributor*> search_contributors;
+			};
+			
+			struct PluginInfo {
+				QString name;
+				QJsonObject manifest;
+				QStringList dependencies;
+				bool is_lazy = false;
+				QList<QAction*> actions;
+				
+				QPluginLoader* loader = nullptr;
+				Plugin* instance = nullptr;
+				bool is_initialized = false;
+				bool is_active = false;
+				QString error;
+				
+				Contributions contributions;
+			};
+			
+			Workbench* const window;
+			
+			QList<PluginInfo*> plugins;  // Discovery order
+			QHash<QString, PluginInfo*> plugins_by_name;
+			QHash<QString, QAction*> actions;
+			ActionProvider* other_actions;  // Actions without a (known) provider
+			
+			QThreadPool pool;
+			BackgroundActivation* background;
+			QList<QPair<PluginInfo*, QPointer<QAction>>> activation_requests;  // Waiting for the running activation
+			
+			PluginInfo* ReadManifest(const QString& file_name);
+			void ConstructActions(PluginInfo* info);
+			ActionProvider* FindProvider(const QString& provider);
+			QList<PluginInfo*> ResolveDependencies(const QList<PluginInfo*>& requested);
+			QHash<PluginInfo*, int> ComputeLevels(const QList<PluginInfo*>& ordered, int& level_count);
+			int StartLevel(const QList<PluginInfo*>& ordered, const QHash<PluginInfo*, int>& levels, int level,
+			               bool is_background);
+			void InitializePlugins(const QList<PluginInfo*>& ordered);
+			bool ActivatePlugins(const QList<PluginInfo*>& ordered);
+			
+			void RequestActivation(PluginInfo* info, QAction* action);
+			void StartNextActivation();
+			void StartBackgroundLevel();
+			void BackgroundPluginInitialized();
+			void WaitForBackgroundActivation();
+			
+			Snapshot CreateSnapshot() const;
+			Contributions CompareSnapshot(const Snapshot& snapshot) const;
+			void RemoveContributions(const Contributions& contributions);
+			void UnloadPlugins(PluginInfo* info, QList<PluginInfo*>& unloaded);
+			
+			static void InitializePlugin(PluginInfo* info);
+		
+		signals:
+			/**
+			 * @brief This signal is emitted after a plugin has been activated.
+			 */
+			void pluginActivated(const QString& name);
+			
+			/**
+			 * @brief This signal is emitted after a plugin has been unloaded.
+			 */
+			void pluginUnloaded(const QString& name);
+	};
+}
+
+#define NOVA_PLUGIN_IID "org.nova.Plugin/1.0"
+Q_DECLARE_INTERFACE(nova::Plugin, NOVA_PLUGIN_IID)
+
+#endif  // NOVA_FRAMEWORK_PLUGIN_H
@@ -187,6 +187,20 @@ namespace nova {
 			 * @param task The task to be displayed
 			 */
 			virtual void UpdateProgressView(bool is_active, const Task* task) = 0;
+			
+			/**
+			 * @brief Displays a task which hasn't been started, e.g. to report progress of work on the GUI thread.
+			 *
+			 * Usually, tasks are displayed automatically while they are running.
+			 *
+			 * @sa Disable()
+			 */
+			void Enable(Task* task);
+			
+			/**
+			 * @brief Stops displaying a task which has been displayed by Enable().
+			 */
+			void Disable(Task* task);
 		
 		private:
 			friend class Task;
@@ -194,8 +208,6 @@ namespace nova {
 			Notifier* const notifier;
 			QList<Task*> tasks;
 			
-			void Enable(Task* task);
-			void Disable(Task* task);
 			void ReportError(const QString& title, const QString& message);
 			void UpdateTasks();
 	};
@@ -6,6 +6,8 @@
 #ifndef NOVA_FRAMEWORK_QUICKDIALOG_H
 #define NOVA_FRAMEWORK_QUICKDIALOG_H
 
+#include <functional>
+
 #include <QList>
 #include <QPoint>
 #include <QStringList>
@@ -18,6 +20,7 @@
 class QIcon;
 class QString;
 class QKeyEvent;
+class QHideEvent;
 
 namespace Ui { class QuickDialog; }
 
@@ -31,6 +34,9 @@ namespace nova {
 	 * Quick dialogs should replace Qt's input dialogs, because they provide a modern look
 	 * and feel.
 	 *
+	 * The prefabricated dialogs of InputText() and InputItem() are created once per parent window and reused
+	 * afterwards. Prewarm() creates them in advance, so that they appear immediately the first time.
+	 *
 	 * @sa InputText()
 	 * @sa InputItem()
 	 */
@@ -90,6 +96,31 @@ namespace nova {
 			static int InputItemIndex(QWidget* parent, const QString& title, const QStringList& items,
 			                          const QList<QIcon>& icons = QList<QIcon>(), int index = 0, bool under_cursor = false);
 			
+			/**
+			 * @brief Queries the index of one item in a list whose items are evaluated lazily.
+			 *
+			 * This overload is suitable for huge lists (e.g. thousands of symbols). The list is virtualized, only the
+			 * visible items are requested from the sources. Typing filters the items, in this case all texts are
+			 * requested once and kept in a compact buffer. The dialog's height is limited to a few rows.
+			 *
+			 * @param parent The parent window
+			 * @param title The dialog's title
+			 * @param count The count of items
+			 * @param text_source Returns the text of the item with the given index
+			 * @param icon_source Returns the icon of the item with the given index (optional, default: no icons)
+			 * @param index The index of the option being selected by default (optional, default: the first one)
+			 * @param under_cursor If this option is enabled, the dialog is centered under the cursor's position using PositionAt().
+			 * (optional, default: off)
+			 *
+			 * @return The index of the selected item or -1 if the dialog was rejected.
+			 *
+			 * @sa InputItem()
+			 */
+			static int InputItemIndex(QWidget* parent, const QString& title, int count,
+			                          const std::function<QString(int)>& text_source,
+			                          const std::function<QIcon(int)>& icon_source = nullptr, int index = 0,
+			                          bool under_cursor = false);
+			
 			/**
 			 * @brief Queries one item in a list using a prefabricated QuickDialog with a list widget as content widget.
 			 *
@@ -116,6 +147,15 @@ namespace nova {
 				return ((result != -1) ? items[result] : QString());
 			}
 			
+			/**
+			 * @brief Creates the reusable dialogs of InputText() and InputItem() for a parent window in advance.
+			 *
+			 * Call this method when the application is idle, e.g. after the main window has been shown.
+			 *
+			 * @param parent The parent window the dialogs will be used with
+			 */
+			static void Prewarm(QWidget* parent);
+			
 			/**
 			 * @brief Centers the dialog at a global point.
 			 *
@@ -162,11 +202,22 @@ namespace nova {
 			 * This method is internally required and should not be called.
 			 */
 			void keyPressEvent(QKeyEvent* event) override;
+			
+			/**
+			 * @brief Please do always call this implementation when overriding.
+			 *
+			 * This method is internally required.
+			 */
+			void hideEvent(QHideEvent* event) override;
 		
 		private:
 			Ui::QuickDialog* const ui;
 			
 			QWidget* content_widget;
+			
+			static QuickDialog* ConstructTextDialog(QWidget* parent);
+			static QuickDialog* ConstructItemDialog(QWidget* parent);
+			static QuickDialog* FindCachedDialog(QWidget* parent, const QString& name);
 	};
 }
 
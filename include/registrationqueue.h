@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#ifndef NOVA_FRAMEWORK_REGISTRATIONQUEUE_H
+#define NOVA_FRAMEWORK_REGISTRATIONQUEUE_H
+
+#include <atomic>
+#include <functional>
+
+#include <QString>
+#include <QList>
+#include <QKeySequence>
+
+#include "nova.h"
+
+namespace nova {
+	class ActionProvider;
+	
+	/**
+	 * @brief Describes an action which is constructed later by nova::RegistrationQueue.
+	 * @headerfile registrationqueue.h <nova/registrationqueue.h>
+	 *
+	 * Only thread-safe types are used, so descriptions can be created on any thread.
+	 */
+	struct NOVA_API ActionDescription {
+		//! The action's title (can contain the hotkey character "&")
+		QString text;
+		//! The action's tool tip (optional)
+		QString tool_tip;
+		//! The action's shortcut (optional)
+		QKeySequence shortcut;
+		//! A file or resource path of the action's icon, theme icons are prefixed with "theme:" (optional)
+		QString icon;
+		//! The action's object name, e.g. to find it later (optional)
+		QString id;
+		//! If the action is important (see nova::ActionGroup::AddAction())
+		bool is_important_action = false;
+		//! Called on the GUI thread when the action is triggered (optional)
+		std::function<void()> triggered;
+	};
+	
+	/**
+	 * @brief Stages action providers, groups and actions from any thread and registers them on the GUI thread.
+	 * @headerfile registrationqueue.h <nova/registrationqueue.h>
+	 *
+	 * nova::Workbench and nova::ActionProvider must only be used on the GUI thread. Instead, code running on
+	 * other threads (e.g. nova::Plugin::Initialize()) describes its contributions to this queue. Staging doesn't
+	 * block: the descriptions are pushed to a lock-free list, which is taken by the GUI thread as a whole.
+	 *
+	 * The GUI thread commits all staged descriptions in one batch. A commit is scheduled automatically when the first
+	 * description is staged, but Commit() can also be called directly. Descriptions are committed in the order they
+	 * have been staged by each thread.
+	 *
+	 * Providers and groups are referenced by title and id. If an action's provider or group doesn't exist when it's
+	 * committed, it's created.
+	 *
+	 * Descriptions staged by nova::Plugin::Initialize() belong to the plugin. They are committed right before the
+	 * plugin is activated and removed together with its other contributions when it's unloaded. Commit() leaves
+	 * them staged.
+	 *
+	 * @sa nova::Workbench::get_registration_queue()
+	 */
+	class NOVA_API RegistrationQueue {
+		public:
+			/**
+			 * @brief Creates a new nova::RegistrationQueue.
+			 *
+			 * Usually, there is no need to create one, use nova::Workbench::get_registration_queue() instead.
+			 *
+			 * @param window The workbench the providers are registered in
+			 */
+			explicit RegistrationQueue(Workbench* window);
+			NOVA_DISABLE_COPY(RegistrationQueue)
+			~RegistrationQueue() noexcept;
+			
+			/**
+			 * @brief Stages a new nova::ActionProvider, which is registered in the workbench.
+			 *
+			 * Nothing happens if there's already a provider with this title.
+			 *
+			 * This method is thread-safe.
+			 */
+			void StageProvider(const QString& title);
+			
+			/**
+			 * @brief Stages a new nova::ActionGroup shown by a provider.
+			 *
+			 * Nothing happens if the provider already has a group with this id.
+			 *
+			 * This method is thread-safe.
+			 *
+			 * @param provider The title of the provider
+			 * @param id The group's id (optional, default: a new negative id)
+			 * @return The group's id
+			 */
+			int StageGroup(const QString& provider, int id = 0);
+			
+			/**
+			 * @brief Stages a new action.
+			 *
+			 * This method is thread-safe.
+			 *
+			 * @param provider The title of the provider
+			 * @param group The id of the group the action is added to. If it's zero, the action gets its own group.
+			 * @param action The description of the action
+			 */
+			void StageAction(const QString& provider, int group, const ActionDescription& action);
+			
+			/**
+			 * @brief Registers all staged descriptions, except the ones belonging to plugins being initialized.
+			 *
+			 * This method must be called on the GUI thread.
+			 *
+			 * @return The count of committed descriptions
+			 */
+			int Commit();
+			
+			/**
+			 * @brief Returns true if there are no staged descriptions.
+			 *
+			 * This method is thread-safe.
+			 */
+			inline bool is_empty() const { return staged.load(std::memory_order_acquire) == nullptr; }
+		
+		private:
+			friend class PluginManager;
+			
+			struct Entry {
+				enum EntryType {
+					Provider,
+					Group,
+					Action
+				} type;
+				
+				QString provider;
+				int group;
+				ActionDescription action;
+				const void* owner;  // The plugin which staged the entry in Initialize() or nullptr
+				
+				Entry* next;
+			};
+			
+			Workbench* const window;
+			
+			std::atomic<Entry*> staged;  // Most recent entry first
+			QList<Entry*> held;  // Taken entries of other owners in staging order (GUI thread only)
+			QList<ActionProvider*> providers;  // Staged providers being owned
+			
+			void Stage(Entry* entry);
+			ActionProvider* ConstructProvider(const QString& title);
+			
+			// Used by nova::PluginManager, the owner is the plugin being initialized
+			int Commit(const void* owner);
+			void Discard(const void* owner);
+			QList<Entry*> TakeEntries(const void* owner);
+			static void SetStagingOwner(const void* owner);
+			bool DeleteProvider(ActionProvider* provider);  // Only unregistered providers constructed by the queue
+	};
+}
+
+#endif  // NOVA_FRAMEWORK_REGISTRATIONQUEUE_H
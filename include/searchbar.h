@@ -6,14 +6,22 @@
 #ifndef NOVA_FRAMEWORK_SEARCHBAR_H
 #define NOVA_FRAMEWORK_SEARCHBAR_H
 
+#include <memory>
+
 #include <QObject>
+#include <QString>
 #include <QList>
+#include <QHash>
+#include <QIcon>
 
 #include "nova.h"
 #include "quickdialog.h"
+#include "searchcontributor.h"
 
 class QAction;
 class QKeyEvent;
+class QShowEvent;
+class QHideEvent;
 class QLineEdit;
 class QTreeWidget;
 class QTreeWidgetItem;
@@ -28,9 +36,17 @@ namespace nova {
 	 * The dialog consists of a line edit which proposes matching actions from all nova::ActionProvider subtypes being registered.
 	 * The results can be immediately invoked by keyboard. Checkable results contain a check box to change their state.
 	 *
+	 * The dialog can be executed several times. Each time it's shown, the previous query is cleared. Before anything is
+	 * typed, the most used actions are proposed (see nova::UsageStore). Used actions are also ranked higher when searching.
+	 *
+	 * The registered nova::SearchContributor objects search concurrently on worker threads. Their results are displayed
+	 * as soon as they arrive. They are merged with the matching actions into one list, which is ordered by score and
+	 * contains the best 100 results. The selected result doesn't change while results are merged.
+	 *
 	 * The translations belong to the context "nova/searchbar".
 	 *
 	 * @sa nova::ActionProvider
+	 * @sa nova::SearchContributor
 	 */
 	class NOVA_API SearchBar : public QuickDialog {
 		Q_OBJECT
@@ -45,17 +61,50 @@ namespace nova {
 			 */
 			explicit SearchBar(Workbench* window = workbench);
 			NOVA_DISABLE_COPY(SearchBar)
+			
+			/**
+			 * @brief Cancels the running search.
+			 */
+			virtual ~SearchBar() noexcept;
 		
 		protected:
 			/**
 			 * This method is internally required and should not be called.
 			 */
 			void keyPressEvent(QKeyEvent* event) override;
+			
+			/**
+			 * @brief Please do always call this implementation when overriding.
+			 *
+			 * This method is internally required.
+			 */
+			void showEvent(QShowEvent* event) override;
+			
+			/**
+			 * @brief Please do always call this implementation when overriding.
+			 *
+			 * This method is internally required.
+			 */
+			void hideEvent(QHideEvent* event) override;
 		
 		private:
+			// A matching action or a contributed result, the category of actions is their provider's title
+			struct Entry {
+				QAction* action;  // nullptr for contributed results
+				SearchResult result;
+			};
+			
 			QLineEdit* search_bar;
 			QTreeWidget* results;
-			QList<QAction*> action_results;
+			QList<Entry> entries;  // Ordered like the items
+			std::shared_ptr<SearchQuery::Session> session;  // Of the running search
+			QHash<QString, QIcon> contributed_icons;  // By path
+			
+			void ShowProposals();
+			void InsertEntry(int index, const Entry& entry);
+			QIcon ContributedIcon(const QString& path);
+			void MergeResults();
+			void CancelSearch();
 		
 		private slots:
 			void suggest();
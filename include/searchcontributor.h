@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#ifndef NOVA_FRAMEWORK_SEARCHCONTRIBUTOR_H
+#define NOVA_FRAMEWORK_SEARCHCONTRIBUTOR_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include <QtGlobal>
+#include <QString>
+#include <QList>
+#include <QRegExp>
+#include <QMutex>
+#include <QThreadPool>
+#include <QElapsedTimer>
+
+#include "nova.h"
+
+namespace nova {
+	/**
+	 * @brief A result being reported by a nova::SearchContributor.
+	 * @headerfile searchcontributor.h <nova/searchcontributor.h>
+	 *
+	 * Results are created on worker threads, so they only contain data which can be copied safely between threads.
+	 */
+	struct NOVA_API SearchResult {
+		//! The displayed text
+		QString text;
+		//! The text displayed next to the result (optional, default: the contributor's title)
+		QString category;
+		//! The result's tool tip (optional)
+		QString tool_tip;
+		//! A file or resource path, theme icons are prefixed with "theme:" (optional)
+		QString icon;
+		//! The relevance between 0 and 1, results with a higher score are listed first (see nova::SearchQuery::Rate())
+		double score = 0;
+		//! The function being called on the GUI thread if the result is chosen
+		std::function<void()> activate;
+	};
+	
+	/**
+	 * @brief The query being passed to nova::SearchContributor::Search().
+	 * @headerfile searchcontributor.h <nova/searchcontributor.h>
+	 *
+	 * The query is cancelled as soon as the user types on or closes nova::SearchBar, or if the contributor's time
+	 * budget is exhausted. Results reported afterwards are discarded.
+	 */
+	class NOVA_API SearchQuery {
+		public:
+			/**
+			 * @brief Returns the text which has been typed.
+			 */
+			inline QString get_text() const { return text; }
+			
+			/**
+			 * @brief Rates how well a text matches the query, using the same wildcard syntax as nova::SearchBar.
+			 *
+			 * @return 1 if the whole text matches, 0.75 if its beginning matches, 0.5 if the beginning of a word
+			 * matches, 0.25 for other matches or 0 if the text doesn't match
+			 */
+			inline double Rate(const QString& text) const { return Rate(reg_exp, text); }
+			
+			/**
+			 * @brief Returns true if the contributor should stop searching.
+			 *
+			 * Long searches should check this regularly.
+			 */
+			bool is_cancelled() const;
+			
+			/**
+			 * @brief Returns the time in milliseconds which is left of the contributor's time budget.
+			 */
+			qint64 get_remaining_time() const;
+			
+			/**
+			 * @brief Sends a result to nova::SearchBar.
+			 *
+			 * Results are displayed while the search is still running. Results reported in a row are merged at once,
+			 * so there's no need to collect them. Nothing happens if the query has been cancelled.
+			 */
+			void Report(const SearchResult& result);
+		
+		private:
+			friend class SearchBar;
+			friend class SearchContributor;
+			
+			// Shared by the queries of all contributors for the same text
+			struct Session {
+				std::atomic<bool> is_cancelled{false};
+				QMutex mutex;
+				QList<SearchResult> pending_results;  // Reported, but not merged yet
+				std::function<void()> notify;  // Posts the merge to the GUI thread, reset when cancelled
+			};
+			
+			QString text;
+			QRegExp reg_exp;  // Each contributor has a copy, since QRegExp is only reentrant
+			QString category;
+			int time_budget;
+			QElapsedTimer clock;  // Started when the search starts
+			std::shared_ptr<Session> session;
+			
+			SearchQuery(const QString& text, const QString& category, int time_budget, std::shared_ptr<Session> session);
+			
+			static double Rate(const QRegExp& reg_exp, const QString& text);
+	};
+	
+	/**
+	 * @brief Contributes results other than actions (e.g. files, symbols or settings values) to nova::SearchBar.
+	 * @headerfile searchcontributor.h <nova/searchcontributor.h>
+	 *
+	 * Tool windows, plugins and other objects can implement this interface and register it using
+	 * nova::Workbench::RegisterSearchContributor(). Each query is passed to all contributors concurrently.
+	 * Each contributor searches on its own worker thread, so a slow contributor never delays the others.
+	 * A contributor's searches are run one after another, so Search() doesn't have to be reentrant, but it must not
+	 * access widgets. Queries being superseded before they are started are skipped.
+	 *
+	 * The results of all contributors and the matching actions are merged into one list, which is ordered by score.
+	 *
+	 * @code
+	 * class FileContributor : public nova::SearchContributor {
+	 *     public:
+	 *         FileContributor() : nova::SearchContributor("Files") {}
+	 *
+	 *     protected:
+	 *         void Search(nova::SearchQuery& query) override {
+	 *             for (const QString& i : files) {  // Only changed on this thread or guarded
+	 *                 if (query.is_cancelled()) return;
+	 *
+	 *                 const double score = query.Rate(QFileInfo(i).fileName());
+	 *                 if (score > 0) query.Report({QFileInfo(i).fileName(), QString(), i, QString(), score, [i]() { Open(i); }});
+	 *             }
+	 *         }
+	 * };
+	 * @endcode
+	 *
+	 * @sa nova::SearchBar
+	 */
+	class NOVA_API SearchContributor {
+		public:
+			/**
+			 * @brief Creates a new nova::SearchContributor.
+			 *
+			 * @param title The title being displayed next to its results
+			 * @param time_budget The time in milliseconds a search may take (optional, default: 200)
+			 */
+			explicit SearchContributor(const QString& title, int time_budget = 200);
+			NOVA_DISABLE_COPY(SearchContributor)
+			
+			/**
+			 * @brief Unregister the contributor before deleting it, so that no search is running anymore.
+			 */
+			virtual ~SearchContributor() noexcept = default;
+			
+			/**
+			 * @brief Returns the title being displayed next to its results.
+			 */
+			inline QString get_title() const { return title; }
+			
+			/**
+			 * @brief Returns the time in milliseconds a search may take.
+			 */
+			inline int get_time_budget() const { return time_budget; }
+			
+			/**
+			 * @brief Sets the time in milliseconds a search may take.
+			 *
+			 * Afterwards, the query is cancelled and further results are discarded.
+			 */
+			inline void set_time_budget(int time_budget) { this->time_budget = time_budget; }
+		
+		protected:
+			/**
+			 * @brief Searches for the query and reports the results.
+			 *
+			 * This method is called on a worker thread.
+			 *
+			 * @sa nova::SearchQuery::Report()
+			 */
+			virtual void Search(SearchQuery& query) = 0;
+		
+		private:
+			friend class SearchBar;
+			friend class Workbench;
+			
+			const QString title;
+			std::atomic<int> time_budget;
+			QThreadPool worker;  // A single thread to run the searches one after another
+			
+			void Start(const SearchQuery& query);
+			void Wait();
+	};
+}
+
+#endif  // NOVA_FRAMEWORK_SEARCHCONTRIBUTOR_H
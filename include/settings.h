@@ -8,7 +8,12 @@
 
 #include <QObject>
 #include <QList>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <QPointer>
 #include <QString>
+#include <QVariant>
 #include <QWidget>
 #include <QAction>
 #include <QDialog>
@@ -16,13 +21,17 @@
 #include "nova.h"
 #include "actionprovider.h"
 
+class QEvent;
 class QHideEvent;
+class QTreeWidgetItem;
 
 namespace Ui { class SettingsDialog; }
 
 namespace nova {
 	class Workbench;
 	class SettingsPage;
+	class SettingsStore;
+	class SettingsIndex;
 }
 
 namespace nova {
@@ -30,7 +39,13 @@ namespace nova {
 	 * @brief A dialog to manipulate the application's settings.
 	 *
 	 * The dialog consist of nova::SettingsPage objects and allows
-	 * to filter all settings by name too.
+	 * to filter all settings by name too. The filter matches settings whose words start with
+	 * the words of the query. Matching settings are highlighted in their pages and listed
+	 * above the navigation, so that the user can directly jump to them.
+	 *
+	 * Pages are loaded when they are opened the first time and only modified pages are applied
+	 * (see nova::SettingsPage::is_modified()). The time
+	 * each page takes is logged using the category "nova.settings" (debug level).
 	 *
 	 * The translations belong to the context "nova/settings".
 	 *
@@ -51,6 +66,7 @@ namespace nova {
 			 */
 			explicit SettingsDialog(Workbench* window = workbench);
 			NOVA_DISABLE_COPY(SettingsDialog)
+			virtual ~SettingsDialog() noexcept;
 			
 			/**
 			 * @brief Opens the requested nova::SettingsPage.
@@ -68,9 +84,17 @@ namespace nova {
 			Workbench* const window;
 			
 			QList<SettingsPage*> pages;
+			QSet<SettingsPage*> loaded_pages;  // Pages are loaded when they are opened the first time
+			
+			// Built once per dialog for the filter
+			SettingsIndex* settings_index;
+			QSet<QWidget*> highlighted_widgets;
+			
+			void LoadSettingsPage(SettingsPage* page);
 		
 		private slots:
 			void lneFilterTextChanged(const QString& query);
+			void trwResultsItemActivated(QTreeWidgetItem* item);
 			
 			void apply();
 			void restoreDefaults();
@@ -98,22 +122,39 @@ namespace nova {
 	 * @sa nova::SettingsDialog
 	 */
 	class NOVA_API SettingsPage : public QObject, public TempActionProvider {
+		Q_OBJECT
+		
 		public:
 			NOVA_DISABLE_COPY(SettingsPage)
 			virtual ~SettingsPage() noexcept;
 			
 			/**
 			 * This method is internally required and should not be called.
+			 *
+			 * Only the actions of settings widgets which have changed since the last call (enabled state, check state or
+			 * title) are updated. If nothing has changed, the call returns immediately.
 			 */
 			void RecreateActions(const Properties& creation_parameters) override;
 			
 			/**
-			 * @brief This pure virtual method is called when the settings are requested
+			 * @brief Forces the next call of RecreateActions() to rebuild all actions of the page.
+			 *
+			 * Changes of the enabled state, the check state of check boxes, the property "nova/setting" and retranslations
+			 * are detected automatically. Call this method if you add or remove settings widgets or if you rename them
+			 * manually (e.g. using QGroupBox::setTitle()).
+			 */
+			inline void InvalidateActions() { needs_rebuild = true; }
+			
+			/**
+			 * @brief This method is called when the settings are requested
 			 * to be reset, i.e. you have to apply the setting's default values.
 			 *
 			 * You only have to manipulate the configuration files.
+			 *
+			 * The default implementation resets all widgets being bound using BindSetting(). If you reimplement
+			 * this method and use bindings too, please call the default implementation.
 			 */
-			virtual void RestoreDefaults() = 0;
+			virtual void RestoreDefaults();
 			
 			/**
 			 * @brief This method checks the configuration file.
@@ -148,6 +189,19 @@ namespace nova {
 			 */
 			inline QString get_title() { return title; }
 			
+			/**
+			 * @brief Returns true if a settings widget might have been changed since the settings were loaded or applied
+			 * the last time.
+			 *
+			 * Nova compares the user properties (e.g. QLineEdit::text or QCheckBox::checked) of all widgets of the page
+			 * with their values after loading. Pages containing editors without a user property (e.g. tables or custom
+			 * editors) can't be compared, so they're always considered modified. MarkModified() can be used if
+			 * a change isn't reflected by the widgets.
+			 *
+			 * Only modified pages are applied by nova::SettingsDialog.
+			 */
+			bool is_modified() const;
+			
 			/**
 			 * @brief Returns the page's content widget.
 			 *
@@ -190,30 +244,109 @@ namespace nova {
 			void set_content_widget(QWidget* content_widget);
 			
 			/**
-			 * @brief This pure virtual method is called when the settings have to be loaded and the widgets have to be updated.
+			 * @brief Returns the nova::SettingsStore used by BindSetting() or nullptr if none is set.
+			 */
+			inline SettingsStore* get_settings_store() const { return settings_store; }
+			
+			/**
+			 * @brief Sets the nova::SettingsStore used by BindSetting().
+			 *
+			 * @sa BindSetting()
+			 */
+			inline void set_settings_store(SettingsStore* settings_store) { this->settings_store = settings_store; }
+			
+			/**
+			 * @brief Binds a settings widget to a key of the page's nova::SettingsStore.
+			 *
+			 * The value is read from and written to the widget's user property (e.g. QLineEdit::text,
+			 * QCheckBox::checked or QSpinBox::value). Bound widgets are handled by the default implementations
+			 * of LoadSettings(), Apply() and RestoreDefaults(), so you don't have to write any code for them.
+			 *
+			 * A store must be set using set_settings_store() before.
+			 *
+			 * @param widget The settings widget (a child of the content widget)
+			 * @param key The setting's key in the store
+			 * @param default_value The value which is used if the key doesn't exist and by RestoreDefaults()
+			 * (optional, default: none)
+			 *
+			 * @sa set_settings_store()
+			 */
+			void BindSetting(QWidget* widget, const QString& key, const QVariant& default_value = QVariant());
+			
+			/**
+			 * @brief Marks the page as modified, so that it's applied by nova::SettingsDialog.
+			 *
+			 * Call this method when a change isn't reflected by the user properties of the widgets (see is_modified()).
+			 */
+			inline void MarkModified() { modified = true; }
+			
+			/**
+			 * @brief This method is called when the settings have to be loaded and the widgets have to be updated.
 			 *
 			 * Your implementation should fill the widgets by loading the configuration files.
 			 *
 			 * Usually, you don't have to call this method manually.
+			 *
+			 * The default implementation loads all widgets being bound using BindSetting(). If you reimplement
+			 * this method and use bindings too, please call the default implementation.
 			 */
-			virtual void LoadSettings() = 0;
+			virtual void LoadSettings();
 			
 			/**
-			 * @brief This pure virtual method is called when the settings have to be saved (e.g. in a configuration file).
+			 * @brief This method is called when the settings have to be saved (e.g. in a configuration file).
 			 *
 			 * This is the "reverse" of LoadSettings().
 			 *
 			 * If you manually change your settings widget, you should always call this method.
+			 *
+			 * The default implementation saves all widgets being bound using BindSetting(). If you reimplement
+			 * this method and use bindings too, please call the default implementation.
+			 */
+			virtual void Apply();
+			
+			/**
+			 * This method is internally required and should not be called.
 			 */
-			virtual void Apply() = 0;
+			bool eventFilter(QObject* watched, QEvent* event) override;
 		
 		private:
 			friend class SettingsDialog;
+			friend class SettingsIndex;
 			friend class Workbench;
 			
+			struct SettingBinding {
+				QWidget* widget;
+				QString key;
+				QVariant default_value;
+			};
+			
 			const QString title;
 			QWidget* content_widget;
 			
+			SettingsStore* settings_store;
+			QList<SettingBinding> bindings;
+			
+			// Change tracking for RecreateActions()
+			Workbench* window;
+			QHash<QWidget*, QAction*> setting_actions;
+			QSet<QWidget*> outdated_widgets;
+			QList<QMetaObject::Connection> tracking_connections;
+			bool needs_rebuild;
+			bool is_updating;
+			
+			// Change detection for nova::SettingsDialog
+			bool modified;  // See MarkModified()
+			bool is_comparable;  // False if an editor has no user property
+			QList<QPair<QPointer<QWidget>, QVariant>> loaded_values;
+			
+			QAction* navigation_action;
+			
+			void MarkUnmodified();
+			void SaveLoadedValues(QWidget* parent);
+			void RebuildActions();
+			void UpdateSettingAction(QWidget* widget, QAction* action);
+			void MarkOutdated(QWidget* widget);
+			
 			// Creates an action to open this page
 			void ConstructNavigationAction(ActionProvider* provider, Workbench* window);
 	};
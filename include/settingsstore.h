@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#ifndef NOVA_FRAMEWORK_SETTINGSSTORE_H
+#define NOVA_FRAMEWORK_SETTINGSSTORE_H
+
+#include <QObject>
+#include <QString>
+#include <QVariant>
+#include <QHash>
+#include <QSettings>
+#include <QReadWriteLock>
+#include <QThreadPool>
+#include <QTimer>
+
+#include "nova.h"
+
+namespace nova {
+	/**
+	 * @brief A copy of all values of a nova::SettingsStore at a specific point in time.
+	 *
+	 * The typedef is translated to QHash<QString, QVariant>.
+	 *
+	 * Snapshots are implicitly shared. Creating one is cheap and the snapshot is never modified
+	 * by later changes of the store, so it can be read safely from any thread.
+	 *
+	 * @sa nova::SettingsStore::Snapshot()
+	 */
+	typedef QHash<QString, QVariant> SettingsSnapshot;
+	
+	/**
+	 * @brief An in-memory cache of a configuration file which writes its changes in the background.
+	 * @headerfile settingsstore.h <nova/settingsstore.h>
+	 *
+	 * The file is read once when the store is created. Afterwards, all reads are served from memory and changes
+	 * are collected and written to disk in batches on a background thread. Multiple changes within the write delay
+	 * result in only one write operation. Pending changes are written when the application quits
+	 * (QCoreApplication::aboutToQuit()) or the store is destroyed.
+	 *
+	 * Values can be read from any thread. Use Snapshot() to read several values consistently.
+	 *
+	 * nova::SettingsPage objects can bind their widgets to the keys of a store (nova::SettingsPage::BindSetting()).
+	 * In this case, no code for loading and applying the settings has to be written.
+	 *
+	 * @sa nova::SettingsPage::BindSetting()
+	 */
+	class NOVA_API SettingsStore : public QObject {
+		Q_OBJECT
+		
+		public:
+			/**
+			 * @brief Creates a new nova::SettingsStore and loads the configuration file.
+			 *
+			 * @param file_name The path of the configuration file
+			 * @param format The file's format (optional, default: QSettings::IniFormat)
+			 * @param parent The QObject's parent (optional, default: none)
+			 */
+			explicit SettingsStore(const QString& file_name, QSettings::Format format = QSettings::IniFormat,
+			                       QObject* parent = nullptr);
+			NOVA_DISABLE_COPY(SettingsStore)
+			
+			/**
+			 * @brief Writes all pending changes before the store is destroyed.
+			 */
+			virtual ~SettingsStore() noexcept;
+			
+			/**
+			 * @brief Returns the value of a key.
+			 *
+			 * @param key The setting's key
+			 * @param default_value The value which is returned if the key doesn't exist (optional, default: an invalid QVariant)
+			 */
+			QVariant Value(const QString& key, const QVariant& default_value = QVariant()) const;
+			
+			/**
+			 * @brief Returns the value of a key converted to the type T.
+			 *
+			 * @param key The setting's key
+			 * @param default_value The value which is returned if the key doesn't exist (optional, default: T())
+			 */
+			template<class T>
+			T TypedValue(const QString& key, const T& default_value = T()) const {
+				return Value(key, QVariant::fromValue(default_value)).template value<T>();
+			}
+			
+			/**
+			 * @brief Changes the value of a key.
+			 *
+			 * The new value is immediately available. It's written to disk after the write delay.
+			 * valueChanged() is only emitted if the value really changes.
+			 *
+			 * @param key The setting's key
+			 * @param value The new value. An invalid QVariant removes the key.
+			 *
+			 * @sa Remove()
+			 */
+			void SetValue(const QString& key, const QVariant& value);
+			
+			/**
+			 * @brief Removes a key from the store.
+			 */
+			inline void Remove(const QString& key) { SetValue(key, QVariant()); }
+			
+			/**
+			 * @brief Returns true if the store contains the key.
+			 */
+			bool Contains(const QString& key) const;
+			
+			/**
+			 * @brief Returns a copy of all values which can be safely read from other threads.
+			 *
+			 * @sa nova::SettingsSnapshot
+			 */
+			SettingsSnapshot Snapshot() const;
+			
+			/**
+			 * @brief Writes all pending changes immediately and waits until they are written.
+			 */
+			void Sync();
+			
+			/**
+			 * @brief Returns the path of the configuration file.
+			 */
+			inline QString get_file_name() const { return file_name; }
+			
+			/**
+			 * @brief Returns the time in milliseconds changes are collected before they are written.
+			 */
+			inline int get_write_delay() const { return write_timer.interval(); }
+			
+			/**
+			 * @brief Sets the time in milliseconds changes are collected before they are written (default: 500).
+			 */
+			inline void set_write_delay(int delay) { write_timer.setInterval(delay); }
+		
+		private:
+			const QString file_name;
+			const QSettings::Format format;
+			
+			mutable QReadWriteLock lock;
+			SettingsSnapshot values;
+			QHash<QString, QVariant> pending_changes;  // Invalid values are removed keys
+			
+			QTimer write_timer;
+			QThreadPool writer;  // A single thread to keep the order of the writes
+		
+		signals:
+			/**
+			 * @brief This signal is emitted when a value has been changed or removed.
+			 *
+			 * @param key The setting's key
+			 * @param value The new value or an invalid QVariant if the key has been removed
+			 */
+			void valueChanged(const QString& key, const QVariant& value);
+		
+		private slots:
+			void writePendingChanges();
+	};
+}
+
+#endif  // NOVA_FRAMEWORK_SETTINGSSTORE_H
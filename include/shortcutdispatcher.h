@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#ifndef NOVA_FRAMEWORK_SHORTCUTDISPATCHER_H
+#define NOVA_FRAMEWORK_SHORTCUTDISPATCHER_H
+
+#include <Qt>
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QKeySequence>
+#include <QAction>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "nova.h"
+
+class QEvent;
+class QKeyEvent;
+
+namespace nova {
+	class ActionProvider;
+	
+	/**
+	 * @brief Triggers the shortcuts of all actions belonging to the registered providers of a workbench.
+	 * @headerfile shortcutdispatcher.h <nova/shortcutdispatcher.h>
+	 *
+	 * The key sequences are stored in a trie, so a key press is resolved in O(sequence length) regardless of the
+	 * count of actions. Multi-key sequences (e.g. "Ctrl+K, Ctrl+C") wait for their next key; if a sequence is also
+	 * the prefix of a longer one, its action is triggered when no further key is pressed in time. Additionally,
+	 * double taps of single keys (e.g. pressing Shift twice) can trigger actions.
+	 *
+	 * The trie is updated incrementally. Added, changed and removed actions are collected and applied before
+	 * the next key press is resolved.
+	 *
+	 * Shortcuts take precedence over Qt's shortcut handling, but widgets which use a key themselves (e.g. line edits
+	 * accepting QEvent::ShortcutOverride) keep it. Only actions with the context Qt::WindowShortcut or
+	 * Qt::ApplicationShortcut which are shown by a visible widget of the workbench (e.g. a menu or a tool bar) are
+	 * dispatched, and only while a widget of the workbench has the focus. If several enabled actions share a key
+	 * sequence, the first one is triggered and the conflict is reported.
+	 *
+	 * @sa nova::Workbench::get_shortcut_dispatcher()
+	 */
+	class NOVA_API ShortcutDispatcher : public QObject {
+		Q_OBJECT
+		
+		public:
+			/**
+			 * @brief Creates a new nova::ShortcutDispatcher.
+			 *
+			 * Usually, there is no need to create one, use nova::Workbench::get_shortcut_dispatcher() instead.
+			 *
+			 * @param window The window whose key presses are dispatched
+			 */
+			explicit ShortcutDispatcher(QWidget* window);
+			NOVA_DISABLE_COPY(ShortcutDispatcher)
+			virtual ~ShortcutDispatcher() noexcept;
+			
+			/**
+			 * @brief Dispatches the shortcuts of the provider's actions, including actions constructed later.
+			 *
+			 * nova::Workbench::RegisterActionProvider() calls this method.
+			 */
+			void AddProvider(ActionProvider* provider);
+			
+			/**
+			 * @brief Stops dispatching the shortcuts of the provider's actions.
+			 *
+			 * nova::Workbench::UnregisterActionProvider() calls this method.
+			 */
+			void RemoveProvider(ActionProvider* provider);
+			
+			/**
+			 * @brief Triggers an action if a key is pressed twice within the double tap interval.
+			 *
+			 * Other keys pressed in between cancel the gesture. Modifier keys (e.g. Qt::Key_Shift) are usually used,
+			 * since their presses have no other meaning.
+			 *
+			 * @param key The key to be tapped
+			 * @param action The action to be triggered or nullptr to remove the gesture
+			 */
+			void SetDoubleTapAction(Qt::Key key, QAction* action);
+			
+			/**
+			 * @brief Returns the action which is triggered by a double tap of the key or nullptr if there's none.
+			 */
+			inline QAction* get_double_tap_action(Qt::Key key) const { return double_taps.value(key, nullptr); }
+			
+			/**
+			 * @brief Returns the action with the given key sequence or nullptr if there's none.
+			 *
+			 * If there's a conflict, the first action is returned.
+			 */
+			QAction* FindAction(const QKeySequence& sequence);
+			
+			/**
+			 * @brief Returns all groups of actions sharing a key sequence.
+			 *
+			 * @sa conflictDetected()
+			 */
+			QList<QList<QAction*>> FindConflicts();
+			
+			/**
+			 * @brief Returns the maximum time in milliseconds between two taps of a double tap (default: 500).
+			 */
+			inline int get_double_tap_interval() const { return double_tap_interval; }
+			
+			/**
+			 * @brief Sets the maximum time in milliseconds between two taps of a double tap.
+			 */
+			inline void set_double_tap_interval(int double_tap_interval) { this->double_tap_interval = double_tap_interval; }
+			
+			/**
+			 * @brief Event filter of the application.
+			 *
+			 * This method is internally required and should not be called.
+			 */
+			bool eventFilter(QObject* watched, QEvent* event) override;
+		
+		private:
+			struct Node {
+				QHash<int, Node*> children;
+				QList<QObject*> actions;  // Actions being triggered by the sequence ending here
+				
+				inline ~Node() noexcept { qDeleteAll(children); }
+			};
+			
+			// A watched child of a provider, it's usually an action
+			struct Entry {
+				bool is_connected = false;
+				QList<QKeySequence> sequences;  // In the trie
+			};
+			
+			QWidget* const window;
+			
+			Node root;
+			QHash<QObject*, Entry> entries;
+			QSet<QObject*> outdated;  // Entries to be updated before the next lookup
+			QHash<QObject*, ActionProvider*> providers;  // By the object owning their actions
+			
+			Node* current;  // State of a multi-key sequence
+			QAction* pending_action;  // Triggered by the next key press event
+			bool is_key_pending;
+			bool is_delivering;  // Sending QEvent::ShortcutOverride to the focus widget
+			QTimer sequence_timer;
+			
+			QHash<int, QAction*> double_taps;
+			int double_tap_interval;
+			int last_tap_key;
+			QElapsedTimer tap_timer;
+			
+			void Watch(QObject* object);
+			void Forget(QObject* object);
+			void ApplyChanges();
+			void Insert(QObject* action, const QList<QKeySequence>& sequences);
+			void Remove(QObject* action, const QList<QKeySequence>& sequences);
+			bool Resolve(int key);
+			void HandleTap(const QKeyEvent* event);
+			QAction* SelectAction(const Node* node) const;
+			
+			static int EventKey(const QKeyEvent* event);
+			static int SequenceKey(const QKeySequence& sequence, int index);
+		
+		signals:
+			/**
+			 * @brief This signal is emitted when an action's key sequence is already used by another action.
+			 *
+			 * @param sequence The key sequence
+			 * @param actions All actions sharing the key sequence
+			 */
+			void conflictDetected(const QKeySequence& sequence, const QList<QAction*>& actions);
+	};
+}
+
+#endif  // NOVA_FRAMEWORK_SHORTCUTDISPATCHER_H
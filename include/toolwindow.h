@@ -6,7 +6,11 @@
 #ifndef NOVA_FRAMEWORK_TOOLWINDOW_H
 #define NOVA_FRAMEWORK_TOOLWINDOW_H
 
+#include <functional>
+
 #include <Qt>
+#include <QString>
+#include <QTimer>
 #include <QDockWidget>
 
 #include "nova.h"
@@ -16,6 +20,7 @@ class QWidget;
 class QAction;
 class QMainWindow;
 class QToolBar;
+class QShowEvent;
 
 namespace nova { class Workbench; }
 
@@ -55,6 +60,13 @@ namespace nova {
 			 * This method is internally required and should not be called.
 			 */
 			inline void set_title(const QString&) override {}
+			
+			/**
+			 * @brief Returns true if the tool window is visible.
+			 *
+			 * This method is internally required and should not be called.
+			 */
+			inline bool is_displayed() const override { return isVisible(); }
 		
 		protected:
 			/**
@@ -94,6 +106,11 @@ namespace nova {
 			 * This method is internally required and should not be called.
 			 */
 			void DisplaySeparators(bool show_regular, int index_regular, bool, int) override;
+			
+			/**
+			 * This method is internally required and should not be called.
+			 */
+			void HideActions(int index, int count, int, int) override;
 		
 		private:
 			friend class Workbench;
@@ -106,8 +123,72 @@ namespace nova {
 			const Qt::Orientation orientation;
 			// For Workbench::RestoreLayout(); it holds the width (vertical ones) or height (horizontal ones) of the tool window
 			int initial_size;
+			QAction* navigation_action;
+			
+			void ConstructNavigationAction(ActionProvider* provider);
+	};
+	
+	/**
+	 * @brief A lightweight dock which stands in for a nova::ToolWindow whose content hasn't been created yet.
+	 * @headerfile toolwindow.h <nova/toolwindow.h>
+	 *
+	 * Placeholders are created by nova::Workbench::RegisterLazyToolWindow(). They have the same title, position and
+	 * navigation action as the real tool window, but don't construct it until they are shown the first time. Then,
+	 * the tool window takes the placeholder's place.
+	 *
+	 * Optionally, the tool window is destroyed again when it stays hidden for a while. In this case, the placeholder
+	 * takes its place until the tool window is shown again.
+	 *
+	 * @sa nova::Workbench::RegisterLazyToolWindow()
+	 */
+	class NOVA_API ToolWindowPlaceholder : public QDockWidget {
+		public:
+			NOVA_DISABLE_COPY(ToolWindowPlaceholder)
+			virtual ~ToolWindowPlaceholder() noexcept = default;
+			
+			/**
+			 * @brief Returns the tool window or nullptr if it hasn't been created yet.
+			 *
+			 * @sa CreateToolWindow()
+			 */
+			inline ToolWindow* get_tool_window() const { return tool_window; }
+			
+			/**
+			 * @brief Creates the tool window if it doesn't exist and returns it.
+			 *
+			 * The tool window is registered and takes the placeholder's place.
+			 *
+			 * @return A pointer to the tool window
+			 */
+			ToolWindow* CreateToolWindow();
+		
+		protected:
+			/**
+			 * This method is internally required and should not be called.
+			 */
+			void showEvent(QShowEvent* event) override;
+		
+		private:
+			friend class Workbench;
+			
+			Workbench* const window;
+			const std::function<ToolWindow*()> factory;
+			ToolWindow* tool_window;
+			
+			Qt::DockWidgetArea default_layout;
+			const bool default_hidden;
+			const Qt::Orientation orientation;
+			
+			QAction* navigation_action;
+			QTimer unload_timer;
+			
+			ToolWindowPlaceholder(Workbench* window, const QString& title, Qt::Orientation orientation,
+			                      Qt::DockWidgetArea default_layout, const std::function<ToolWindow*()>& factory,
+			                      int unload_delay);
 			
 			void ConstructNavigationAction(ActionProvider* provider);
+			void UpdateNavigationAction(bool is_visible);
+			void DestroyToolWindow();
 	};
 }
 
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#ifndef NOVA_FRAMEWORK_TRACE_H
+#define NOVA_FRAMEWORK_TRACE_H
+
+#include <QtGlobal>
+#include <QString>
+
+#include "nova.h"
+
+/**
+ * @file trace.h
+ *
+ * Scoped trace points are only compiled if Nova is configured with the CMake option NOVA_TRACING.
+ * Otherwise, the macros expand to nothing and don't cause any overhead.
+ *
+ * If the environment variable NOVA_TRACE_FILE is set, the recorded timeline is written to this file when the
+ * application quits (see QCoreApplication::aboutToQuit()) and once more when QCoreApplication is destroyed.
+ * nova::Trace::WriteChromeTrace() writes it at any other time. The file uses the Chrome trace event format and can be opened with chrome://tracing
+ * or <a href="https://ui.perfetto.dev">Perfetto</a>.
+ */
+
+#ifdef NOVA_TRACING
+
+// Two helper macros are required to expand __LINE__ before concatenating
+#define NOVA_TRACE_CONCAT_HELPER(a, b) a##b
+#define NOVA_TRACE_CONCAT(a, b) NOVA_TRACE_CONCAT_HELPER(a, b)
+
+/**
+ * @brief Records the time until the end of the current scope as a trace event.
+ *
+ * @param name A string literal which names the event. Only the pointer is stored.
+ */
+#define NOVA_TRACE_SCOPE(name) const nova::TraceScope NOVA_TRACE_CONCAT(nova_trace_scope_, __LINE__)(name)
+
+/**
+ * @brief Records the time until the end of the current function as a trace event named after the function.
+ */
+#define NOVA_TRACE_FUNCTION() NOVA_TRACE_SCOPE(Q_FUNC_INFO)
+
+namespace nova {
+	/**
+	 * @brief Records the lifetime of the object as a trace event.
+	 * @headerfile trace.h <nova/trace.h>
+	 *
+	 * Use NOVA_TRACE_SCOPE() and NOVA_TRACE_FUNCTION() instead of this class, so that the trace points are removed
+	 * if tracing is disabled.
+	 *
+	 * Recording an event only takes two reads of a monotonic clock and appending it to a buffer. Events
+	 * can be recorded from any thread. The buffer keeps the latest 262144 events, older ones are overwritten.
+	 *
+	 * @sa nova::Trace
+	 */
+	class NOVA_API TraceScope {
+		public:
+			/**
+			 * @brief Starts the trace event.
+			 *
+			 * @param name The event's name. It must live until the trace is written, usually it's a string literal.
+			 */
+			explicit TraceScope(const char* name) noexcept;
+			NOVA_DISABLE_COPY(TraceScope)
+			
+			/**
+			 * @brief Ends the trace event and records it.
+			 */
+			~TraceScope() noexcept;
+		
+		private:
+			const char* const name;
+			const qint64 start;
+	};
+	
+	/**
+	 * @brief Provides access to the recorded trace events.
+	 * @headerfile trace.h <nova/trace.h>
+	 *
+	 * The time is measured relative to the moment Nova is loaded, so the timeline covers the whole startup.
+	 *
+	 * @sa NOVA_TRACE_SCOPE()
+	 */
+	class NOVA_API Trace {
+		public:
+			Trace() = delete;
+			
+			/**
+			 * @brief Returns the time in nanoseconds since Nova was loaded.
+			 */
+			static qint64 Now() noexcept;
+			
+			/**
+			 * @brief Records a complete trace event.
+			 *
+			 * @param name The event's name. It must live until the trace is written, usually it's a string literal.
+			 * @param start The event's start time (see Now())
+			 * @param duration The event's duration in nanoseconds
+			 */
+			static void Record(const char* name, qint64 start, qint64 duration) noexcept;
+			
+			/**
+			 * @brief Writes all events recorded so far as Chrome trace event JSON.
+			 *
+			 * If more events have been recorded than the buffer can keep, only the latest ones are written.
+			 *
+			 * @param file_name The path of the file to be written
+			 * @return True on success
+			 */
+			static bool WriteChromeTrace(const QString& file_name);
+	};
+}
+
+#else
+
+#define NOVA_TRACE_SCOPE(name)
+#define NOVA_TRACE_FUNCTION()
+
+#endif  // NOVA_TRACING
+
+#endif  // NOVA_FRAMEWORK_TRACE_H
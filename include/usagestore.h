@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#ifndef NOVA_FRAMEWORK_USAGESTORE_H
+#define NOVA_FRAMEWORK_USAGESTORE_H
+
+#include <QtGlobal>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QByteArray>
+#include <QPointer>
+#include <QAction>
+#include <QTimer>
+
+#include "nova.h"
+
+namespace nova {
+	class SettingsStore;
+	
+	/**
+	 * @brief Remembers which actions are used, so that nova::SearchBar can propose them.
+	 * @headerfile usagestore.h <nova/usagestore.h>
+	 *
+	 * Each use of an action adds 1 to its score. The score decays exponentially: after the half-life, a use only counts
+	 * half. So, the score combines how frequently and how recently an action is used. The ranking by score is updated
+	 * with each use, so listing the most used actions is cheap.
+	 *
+	 * The store is bounded: if there are more entries than the capacity, the entry with the lowest score is removed.
+	 *
+	 * Actions are identified by their provider's title and their object name (or text without "&" if there's none),
+	 * so that entries stay valid when the actions are recreated or the application is restarted.
+	 *
+	 * @sa nova::Workbench::get_usage_store()
+	 */
+	class NOVA_API UsageStore : public QObject {
+		Q_OBJECT
+		
+		public:
+			/**
+			 * @brief Creates an empty nova::UsageStore.
+			 *
+			 * Usually, there is no need to create one, use nova::Workbench::get_usage_store() instead.
+			 *
+			 * @param parent The QObject's parent (optional, default: none)
+			 */
+			explicit UsageStore(QObject* parent = nullptr);
+			NOVA_DISABLE_COPY(UsageStore)
+			
+			/**
+			 * @brief Writes pending changes before the store is destroyed.
+			 */
+			virtual ~UsageStore() noexcept;
+			
+			/**
+			 * @brief Records a use of an action.
+			 *
+			 * nova::ActionProvider records the uses of its constructed and migrated actions automatically.
+			 *
+			 * @param provider The title of the action's provider
+			 * @param action The action being used
+			 */
+			void RecordUse(const QString& provider, QAction* action);
+			
+			/**
+			 * @brief Associates an action with an entry, e.g. after the application has been restarted.
+			 *
+			 * Nothing happens if there's no entry for the action.
+			 *
+			 * @param provider The title of the action's provider
+			 * @param action The action
+			 */
+			void Associate(const QString& provider, QAction* action);
+			
+			/**
+			 * @brief Returns the current scores of the actions associated with entries.
+			 *
+			 * Actions which haven't been used have a score of 0.
+			 */
+			QHash<QAction*, double> ListScores() const;
+			
+			/**
+			 * @brief Returns the actions with the highest scores, beginning with the highest one.
+			 *
+			 * Entries which aren't associated with an existing action are skipped (see Associate()).
+			 *
+			 * @param count The maximum count of actions
+			 * @param providers Receives the titles of the actions' providers (optional, default: none)
+			 */
+			QList<QAction*> ListRanked(int count, QStringList* providers = nullptr) const;
+			
+			/**
+			 * @brief Returns the titles of the providers having entries which aren't associated with an action.
+			 *
+			 * Only the entries with the given rank or higher are considered.
+			 */
+			QStringList ListUnassociated(int count) const;
+			
+			/**
+			 * @brief Removes all entries.
+			 */
+			void Clear();
+			
+			/**
+			 * @brief Loads the entries from a settings store and saves them there after each change.
+			 *
+			 * Changes are collected for a second, then they are written by the settings store in the background.
+			 * Pending changes are written when the application quits.
+			 *
+			 * @param store The settings store
+			 * @param key The store's key of the entries (optional, default: "nova/usage")
+			 */
+			void EnablePersistence(SettingsStore* store, const QString& key = "nova/usage");
+			
+			/**
+			 * @brief Writes pending changes to disk immediately, if persistence is enabled.
+			 *
+			 * nova::Workbench calls this method when it's closed.
+			 */
+			void Sync();
+			
+			/**
+			 * @brief Returns the count of entries.
+			 */
+			inline int get_count() const { return entries.count(); }
+			
+			/**
+			 * @brief Returns the maximum count of entries.
+			 */
+			inline int get_capacity() const { return capacity; }
+			
+			/**
+			 * @brief Sets the maximum count of entries (default: 200).
+			 */
+			void set_capacity(int capacity);
+			
+			/**
+			 * @brief Returns the time in hours after which a use counts half.
+			 */
+			inline double get_half_life() const { return half_life; }
+			
+			/**
+			 * @brief Sets the time in hours after which a use counts half (default: 168, i.e. a week).
+			 */
+			void set_half_life(double half_life);
+			
+			/**
+			 * @brief Returns the identifier of an action within its provider.
+			 */
+			static QString ActionName(const QAction* action);
+		
+		private:
+			struct Entry {
+				QString provider;
+				QString name;
+				double score;  // At last_use
+				qint64 last_use;  // Milliseconds since epoch
+				QPointer<QAction> action;
+			};
+			
+			QHash<QString, Entry*> entries;
+			QList<Entry*> ranking;  // Highest score first
+			
+			int capacity;
+			double half_life;
+			
+			SettingsStore* store;
+			QString key;
+			QTimer save_timer;
+			
+			double DecayedScore(const Entry* entry, qint64 now) const;
+			void UpdateRanking();
+			void Save();
+			QByteArray Serialize() const;
+			bool Deserialize(const QByteArray& data);
+		
+		signals:
+			/**
+			 * @brief This signal is emitted after a use has been recorded.
+			 */
+			void used(QAction* action);
+	};
+}
+
+#endif  // NOVA_FRAMEWORK_USAGESTORE_H
@@ -6,10 +6,16 @@
 #ifndef NOVA_FRAMEWORK_WORKBENCH_H
 #define NOVA_FRAMEWORK_WORKBENCH_H
 
+#include <functional>
+
 #include <QtGlobal>
 #include <QObject>
 #include <QList>
+#include <QHash>
 #include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QTimer>
 #include <QMainWindow>
 #include <QSystemTrayIcon>
 
@@ -19,10 +25,12 @@
 #include "toolwindow.h"
 #include "notification.h"
 #include "settings.h"
+#include "trace.h"
 
 class QWidget;
+class QEvent;
 class QShowEvent;
-class QKeyEvent;
+class QCloseEvent;
 class QAction;
 
 #ifdef WIN32
@@ -34,6 +42,13 @@ namespace Ui { class Workbench; }
 namespace nova {
 	class MenuActionProvider;
 	class SearchBar;
+	class SettingsStore;
+	class PluginManager;
+	class RegistrationQueue;
+	class IdleQueue;
+	class ShortcutDispatcher;
+	class UsageStore;
+	class SearchContributor;
 }
 
 namespace nova {
@@ -103,27 +118,60 @@ namespace nova {
 			 * Usually, if you add content using one of the register methods, their providers
 			 * get automatically registered and calling this method is not required.
 			 *
+			 * This method must be called on the GUI thread, other threads use get_registration_queue().
+			 * The shortcuts of the provider's actions are dispatched by get_shortcut_dispatcher().
+			 * Providers being a nova::SearchContributor too have to be registered by RegisterSearchContributor().
+			 *
 			 * @param provider The nova::ActionProvider to be registered
 			 *
 			 * @sa UnregisterActionProvider()
 			 */
-			inline void RegisterActionProvider(ActionProvider* provider) {
-				providers << provider;
-			}
+			void RegisterActionProvider(ActionProvider* provider);
 			
 			/**
 			 * @brief Unregisters a nova::ActionProvider.
 			 *
 			 * Its actions won't be available anymore in nova::SearchBar once
-			 * unregistered.
+			 * unregistered. If the provider is a nova::SearchContributor too, it's unregistered as well.
 			 *
 			 * @param provider The nova::ActionProvider to be unregistered
 			 *
 			 * @sa RegisterActionProvider()
 			 */
-			inline void UnregisterActionProvider(ActionProvider* provider) {
-				providers.removeAll(provider);
-			}
+			void UnregisterActionProvider(ActionProvider* provider);
+			
+			/**
+			 * @brief Returns the first registered nova::ActionProvider with the given title.
+			 *
+			 * The hotkey character "&" is ignored, so "File" finds the standard menu "&File".
+			 *
+			 * @return The provider or nullptr if there's none
+			 */
+			ActionProvider* FindActionProvider(const QString& title) const;
+			
+			/**
+			 * @brief Adds a nova::SearchContributor, whose results will be available in nova::SearchBar.
+			 *
+			 * The workbench doesn't take ownership of the contributor. Tool windows and plugins usually register
+			 * their contributors when they're created or activated.
+			 *
+			 * @param contributor The nova::SearchContributor to be registered
+			 *
+			 * @sa UnregisterSearchContributor()
+			 */
+			void RegisterSearchContributor(SearchContributor* contributor);
+			
+			/**
+			 * @brief Unregisters a nova::SearchContributor.
+			 *
+			 * If the contributor is searching, this method waits until the search returns. Afterwards, the contributor
+			 * can be deleted.
+			 *
+			 * @param contributor The nova::SearchContributor to be unregistered
+			 *
+			 * @sa RegisterSearchContributor()
+			 */
+			void UnregisterSearchContributor(SearchContributor* contributor);
 			
 			/**
 			 * @brief Adds a nova::ToolWindow class to the workbench.
@@ -138,16 +186,58 @@ namespace nova {
 			 */
 			template<class T>
 			T* RegisterToolWindow() {
+				NOVA_TRACE_SCOPE("Workbench::RegisterToolWindow");
+				
 				ToolWindow* tool_window = new T(static_cast<QWidget*>(this));
 				
 				RegisterActionProvider(tool_window);
 				tool_windows << tool_window;
 				tool_window->ConstructNavigationAction(&tool_window_actions);
 				addDockWidget(tool_window->default_layout, tool_window);
+				RestoreLateLayout(tool_window);
 				
 				return static_cast<T*>(tool_window);
 			}
 			
+			/**
+			 * @brief Adds a nova::ToolWindow class to the workbench without constructing it.
+			 *
+			 * A lightweight placeholder with the given title is docked instead. The tool window itself is created
+			 * when the placeholder is shown the first time, e.g. because the user activates the navigation action.
+			 * This keeps the startup fast if there are many or expensive tool windows.
+			 *
+			 * The tool window's own actions can be found using nova::SearchBar once it has been created.
+			 *
+			 * The subclass must have a constructor with QWidget* as parameter (the tool window's parent window)
+			 *
+			 * @tparam T The class to be registered
+			 * @param title The tool window's title. It should be the same as the one of the tool window.
+			 * @param orientation The tool window's orientation
+			 * @param default_layout The area where the tool window is displayed by default (optional, default: hidden)
+			 * @param unload_delay The time in milliseconds after which a hidden tool window is destroyed again.
+			 *                     A negative value keeps it (optional, default: -1)
+			 * @return The placeholder of the tool window
+			 *
+			 * @sa RegisterToolWindow()
+			 * @sa nova::ToolWindowPlaceholder
+			 */
+			template<class T>
+			ToolWindowPlaceholder* RegisterLazyToolWindow(const QString& title, Qt::Orientation orientation,
+			                                              Qt::DockWidgetArea default_layout = Qt::NoDockWidgetArea,
+			                                              int unload_delay = -1) {
+				NOVA_TRACE_SCOPE("Workbench::RegisterLazyToolWindow");
+				
+				ToolWindowPlaceholder* placeholder = new ToolWindowPlaceholder(this, title, orientation, default_layout,
+						[this]() -> ToolWindow* { return new T(static_cast<QWidget*>(this)); }, unload_delay);
+				
+				tool_window_placeholders << placeholder;
+				placeholder->ConstructNavigationAction(&tool_window_actions);
+				addDockWidget(placeholder->default_layout, placeholder);
+				RestoreLateLayout(placeholder);
+				
+				return placeholder;
+			}
+			
 			/**
 			 * @brief Adds a nova::SettingsPage class to the workbench.
 			 *
@@ -163,6 +253,8 @@ namespace nova {
 			 */
 			template<class T>
 			T* RegisterSettingsPage() {
+				NOVA_TRACE_SCOPE("Workbench::RegisterSettingsPage");
+				
 				SettingsPage* settings_page = new T(static_cast<QObject*>(this));
 				
 				Properties parameters;
@@ -176,6 +268,38 @@ namespace nova {
 				return static_cast<T*>(settings_page);
 			}
 			
+			/**
+			 * @brief Removes a tool window from the workbench and deletes it.
+			 *
+			 * The tool window is removed from the docking area, its navigation action is deleted and its provider is
+			 * unregistered. If the tool window has been created by a placeholder, the placeholder is removed too.
+			 *
+			 * @param tool_window The tool window to be removed
+			 *
+			 * @sa RegisterToolWindow()
+			 */
+			void UnregisterToolWindow(ToolWindow* tool_window);
+			
+			/**
+			 * @brief Removes a lazy tool window's placeholder and its tool window (if it exists) from the workbench.
+			 *
+			 * @param placeholder The placeholder to be removed
+			 *
+			 * @sa RegisterLazyToolWindow()
+			 */
+			void UnregisterToolWindow(ToolWindowPlaceholder* placeholder);
+			
+			/**
+			 * @brief Removes a settings page from the workbench and deletes it.
+			 *
+			 * Its navigation action is deleted and its provider is unregistered. The settings dialog must not be open.
+			 *
+			 * @param settings_page The page to be removed
+			 *
+			 * @sa RegisterSettingsPage()
+			 */
+			void UnregisterSettingsPage(SettingsPage* settings_page);
+			
 			/**
 			 * @brief Starts nova::SettingsDialog and opens a specific page.
 			 *
@@ -210,6 +334,13 @@ namespace nova {
 			 */
 			inline QList<ActionProvider*> get_action_providers() const { return providers; }
 			
+			/**
+			 * @brief Returns a list of all search contributors being registered.
+			 *
+			 * @sa RegisterSearchContributor()
+			 */
+			inline QList<SearchContributor*> get_search_contributors() const { return search_contributors; }
+			
 			/**
 			 * @brief Returns a list of all tool windows being associated with this workbench.
 			 *
@@ -218,6 +349,13 @@ namespace nova {
 			 */
 			inline QList<ToolWindow*> get_tool_windows() const { return tool_windows; }
 			
+			/**
+			 * @brief Returns a list of all placeholders of lazy tool windows.
+			 *
+			 * @sa RegisterLazyToolWindow()
+			 */
+			inline QList<ToolWindowPlaceholder*> get_tool_window_placeholders() const { return tool_window_placeholders; }
+			
 			/**
 			 * @brief Returns a list of all settings pages being associated with this workbench.
 			 *
@@ -244,6 +382,168 @@ namespace nova {
 			 * @sa get_system_tray_menu()
 			 */
 			inline MenuActionProvider* get_system_tray_menu() const { return menu_tray; }
+			
+			/**
+			 * @brief Returns a snapshot of the current layout (geometry, tool bars and tool windows).
+			 *
+			 * The snapshot is versioned with the version passed to EnableLayoutPersistence().
+			 *
+			 * @sa ApplyLayoutSnapshot()
+			 */
+			QByteArray CreateLayoutSnapshot() const;
+			
+			/**
+			 * @brief Restores a layout in one pass.
+			 *
+			 * Updates are suspended while the layout is applied, so the workbench is repainted only once.
+			 *
+			 * @param snapshot A snapshot created by CreateLayoutSnapshot()
+			 * @return False if the snapshot is invalid or has another version
+			 *
+			 * @sa CreateLayoutSnapshot()
+			 */
+			bool ApplyLayoutSnapshot(const QByteArray& snapshot);
+			
+			/**
+			 * @brief Saves the current layout as a named preset.
+			 *
+			 * An existing preset with the same name is replaced. If layout persistence is enabled, the preset is
+			 * saved in the nova::SettingsStore too.
+			 *
+			 * @sa ApplyLayoutPreset()
+			 */
+			void SaveLayoutPreset(const QString& name);
+			
+			/**
+			 * @brief Switches to a named layout preset.
+			 *
+			 * @return False if the preset doesn't exist or can't be applied
+			 *
+			 * @sa SaveLayoutPreset()
+			 */
+			bool ApplyLayoutPreset(const QString& name);
+			
+			/**
+			 * @brief Removes a named layout preset.
+			 */
+			void RemoveLayoutPreset(const QString& name);
+			
+			/**
+			 * @brief Returns the names of all layout presets.
+			 */
+			inline QStringList get_layout_presets() const { return layout_presets.keys(); }
+			
+			/**
+			 * @brief Returns how many updates of the status bar have been avoided.
+			 *
+			 * Progress and notification changes are collected and applied at most once per frame (~16 ms).
+			 * Each change that was merged into a pending update and each unchanged property that wasn't
+			 * set again counts as one avoided update.
+			 */
+			inline quint64 get_avoided_view_updates() const { return avoided_view_updates; }
+			
+			/**
+			 * @brief Creates the search bar and the quick dialogs in advance, so that they appear immediately.
+			 *
+			 * This method is called by the idle queue after the workbench has been shown the first time,
+			 * unless it's disabled by set_dialog_prewarming().
+			 *
+			 * @sa nova::QuickDialog::Prewarm()
+			 */
+			void PrewarmDialogs();
+			
+			/**
+			 * @brief Returns if the dialogs are created in advance after the workbench has been shown.
+			 */
+			inline bool is_dialog_prewarming() const { return dialog_prewarming; }
+			
+			/**
+			 * @brief Sets if the dialogs are created in advance after the workbench has been shown (default: true).
+			 *
+			 * @sa PrewarmDialogs()
+			 */
+			inline void set_dialog_prewarming(bool dialog_prewarming) { this->dialog_prewarming = dialog_prewarming; }
+			
+			/**
+			 * @brief Queues a job, which is run on the GUI thread after the workbench has been shown the first time.
+			 *
+			 * This allows the window to be painted before all menus, tool windows, settings pages and plugins
+			 * exist. The jobs are run in time slices (see set_startup_budget()), between them the event loop processes
+			 * input and paint events. The progress is displayed by the progress monitor.
+			 *
+			 * If layout persistence is enabled, the layout is restored after the last job.
+			 * Jobs scheduled after the startup are run in the next slice.
+			 *
+			 * @param job The job to be run, e.g. a lambda calling RegisterToolWindow()
+			 * @param priority Jobs with a higher priority are run first, jobs with the same priority in the order they
+			 * are scheduled (optional, default: 0)
+			 */
+			void ScheduleStartupJob(const std::function<void()>& job, int priority = 0);
+			
+			/**
+			 * @brief Returns true until all startup jobs have been run.
+			 *
+			 * @sa ScheduleStartupJob()
+			 */
+			inline bool is_starting_up() const { return !startup_jobs.isEmpty(); }
+			
+			/**
+			 * @brief Returns the time in milliseconds the startup jobs may take per event loop iteration.
+			 */
+			inline int get_startup_budget() const { return startup_budget; }
+			
+			/**
+			 * @brief Sets the time in milliseconds the startup jobs may take per event loop iteration (default: 4).
+			 *
+			 * At least one job is run per iteration.
+			 */
+			inline void set_startup_budget(int startup_budget) { this->startup_budget = startup_budget; }
+			
+			/**
+			 * @brief Returns the plugin manager, which loads the plugins into this workbench.
+			 *
+			 * @sa nova::PluginManager::LoadPlugins()
+			 */
+			inline PluginManager* get_plugin_manager() const { return plugin_manager; }
+			
+			/**
+			 * @brief Returns the queue which registers action providers, groups and actions staged by other threads.
+			 *
+			 * All other registration methods must be called on the GUI thread.
+			 */
+			inline RegistrationQueue* get_registration_queue() const { return registration_queue; }
+			
+			/**
+			 * @brief Returns the dispatcher which triggers the shortcuts of the registered providers' actions.
+			 *
+			 * Pressing Shift twice triggers the search bar action (see ConstructStandardAction()).
+			 */
+			inline ShortcutDispatcher* get_shortcut_dispatcher() const { return shortcut_dispatcher; }
+			
+			/**
+			 * @brief Returns the store which records the uses of actions, nova::SearchBar proposes the most used ones.
+			 *
+			 * @sa nova::UsageStore::EnablePersistence() to remember the uses after a restart
+			 */
+			inline UsageStore* get_usage_store() const { return usage_store; }
+			
+			/**
+			 * @brief Marks the state of all actions as outdated, e.g. because the selection or the document changed.
+			 *
+			 * The update functions of displayed providers (visible menus, tool bars and tool windows) are called in one
+			 * pass when the event loop is idle. So, invalidating the context several times in a row is cheap.
+			 * Other providers are updated when they are displayed or searched.
+			 *
+			 * @sa nova::ActionProvider::SetUpdateCallback()
+			 */
+			void InvalidateActionStates();
+			
+			/**
+			 * @brief Returns the queue which runs jobs on the GUI thread while the event loop is idle.
+			 *
+			 * The workbench uses it to prepare the dialogs and to update the actions of the settings pages.
+			 */
+			inline IdleQueue* get_idle_queue() const { return idle_queue; }
 		
 		protected:
 			/**
@@ -310,6 +610,16 @@ namespace nova {
 			 */
 			void AddStatusBarWidget(QWidget* widget, int stretch = 1);
 			
+			/**
+			 * @brief Removes a widget inserted by AddStatusBarWidget() and deletes it.
+			 */
+			void RemoveStatusBarWidget(QWidget* widget);
+			
+			/**
+			 * @brief Returns the widgets inserted by AddStatusBarWidget().
+			 */
+			inline QList<QWidget*> get_status_bar_widgets() const { return status_bar_widgets; }
+			
 			/**
 			 * @brief Creates and shows an icon in the system's tray menu.
 			 *
@@ -333,6 +643,26 @@ namespace nova {
 			 */
 			void RestoreLayout();
 			
+			/**
+			 * @brief Saves the layout in a nova::SettingsStore and restores it when the workbench is shown.
+			 *
+			 * The layout is restored once, when the workbench is shown the first time. Tool windows and tool bars
+			 * added later (e.g. by plugins) are moved to their saved position when they're added. Afterwards, each change
+			 * of the tool bars and tool windows saves the layout again in the background. Stored layouts with
+			 * another version are ignored, so increase the version if the tool windows or tool bars change
+			 * incompatibly.
+			 *
+			 * Call this method in the constructor of the subclass.
+			 *
+			 * @param store The store the layout and the presets are saved in
+			 * @param version The layout's version (optional, default: 0)
+			 * @param key The store's key of the layout (optional, default: "nova/layout")
+			 *
+			 * @sa CreateLayoutSnapshot()
+			 * @sa SaveLayoutPreset()
+			 */
+			void EnableLayoutPersistence(SettingsStore* store, int version = 0, const QString& key = "nova/layout");
+			
 			/**
 			 * @brief Please do always call this implementation when overriding.
 			 *
@@ -345,7 +675,14 @@ namespace nova {
 			 *
 			 * This method is internally required.
 			 */
-			void keyPressEvent(QKeyEvent* event) override;
+			void closeEvent(QCloseEvent* event) override;
+			
+			/**
+			 * @brief Please do always call this implementation when overriding.
+			 *
+			 * This method is internally required.
+			 */
+			void changeEvent(QEvent* event) override;
 			
 			/**
 			 * This method is internally required and should not be called.
@@ -367,6 +704,7 @@ namespace nova {
 		private:
 			friend class SearchBar;
 			friend class SettingsDialog;
+			friend class ToolWindowPlaceholder;
 			
 			Ui::Workbench* const ui;
 			
@@ -379,15 +717,79 @@ namespace nova {
 			ActionProvider settings_page_actions;
 			
 			QList<ActionProvider*> providers;
+			QList<SearchContributor*> search_contributors;
 			QList<ToolWindow*> tool_windows;
+			QList<ToolWindowPlaceholder*> tool_window_placeholders;
 			QList<SettingsPage*> settings_pages;
+			QList<QWidget*> status_bar_widgets;
 			
 			QSystemTrayIcon* tray_icon;
+			SearchBar* search_bar_dialog;  // Reused for each search
+			bool dialog_prewarming;
+			
+			// Progressive startup, sorted by priority
+			struct StartupJob {
+				int priority;
+				std::function<void()> job;
+			};
+			
+			QList<StartupJob> startup_jobs;
+			int startup_budget;
+			int startup_job_count;
+			Task* startup_task;
+			bool is_startup_scheduled;
+			bool is_shown;
+			
+			PluginManager* const plugin_manager;
+			RegistrationQueue* const registration_queue;
+			IdleQueue* const idle_queue;
+			ShortcutDispatcher* const shortcut_dispatcher;
+			UsageStore* const usage_store;
+			QList<SettingsPage*> outdated_settings_pages;  // Actions are recreated when the event loop is idle
+			
+			SettingsStore* layout_store;
+			QString layout_key;
+			int layout_version;
+			bool is_layout_restored;
+			QTimer layout_timer;
+			QHash<QString, QByteArray> layout_presets;
+			
+			// State of the progress and notification views, copied because tasks and notifications may be deleted
+			struct ViewState {
+				bool is_progress_active = false;
+				QString progress_text;
+				bool is_indeterminate = false;
+				int progress_value = 0;
+				
+				bool is_notification_active = false;
+				QString notification_text;
+				Notification::NotificationType notification_type = Notification::Information;
+				QString notification_links;
+			};
+			
+			ViewState pending_view;
+			ViewState applied_view;
+			bool is_progress_pending;
+			bool is_notification_pending;
+			bool is_view_initialized;
+			quint64 avoided_view_updates;
+			QTimer view_timer;
 
 #ifdef WIN32
 			ITaskbarList4* taskbar;
 #endif
 			
+			void TrackLayoutChanges(QWidget* widget);
+			void RestorePersistentLayout();
+			void RestoreLateLayout(QWidget* widget);  // Added after RestorePersistentLayout()
+			void SaveLayout();
+			void RunStartupSlice();
+			void ApplyViewUpdates();
+			void UpdateDisplayedActions();
+			void ScheduleSettingsActions(const QList<SettingsPage*>& pages);
+			void FlushSettingsActions();
+			void AssociateUsedActions(int count);
+		
 		private slots:
 			void sysTrayActivated(QSystemTrayIcon::ActivationReason reason = QSystemTrayIcon::Trigger);
 			void notificationLinkActivated(const QString& link);
@@ -8,15 +8,30 @@
 #include <QList>
 #include <QSize>
 #include <QWidget>
+#include <QAction>
 
 #include "workbench.h"
+#include "usagestore.h"
+#include "trace.h"
+
+namespace {
+	void HideWidgetActions(QWidget* widget, int index, int count) {
+		const QList<QAction*> actions = widget->actions();
+		for (int i = qMax(0, index) ; i < qMin(index + count, actions.count()) ; ++i) {
+			widget->removeAction(actions[i]);
+			
+			// Separators are owned by the widget
+			if (actions[i]->isSeparator() && (actions[i]->parent() == widget)) delete actions[i];
+		}
+	}
+}
 
 namespace nova {
-	int ActionGroup::id_counter = 0;
+	std::atomic<int> ActionGroup::id_counter(0);
 	
 	ActionGroup::ActionGroup(int id):
 			id(id), num_shown(0), has_important_action(false), important_action_shown(false),
-			my_index(-1), current_index(-1), current_index_important(-1), provider(nullptr) {}
+			has_separator(false), has_important_separator(false), my_index(-1), current_index(-1), current_index_important(-1), provider(nullptr) {}
 	
 	ActionGroup::ActionGroup(QAction* action, bool is_important_action):
 			ActionGroup() {
@@ -37,6 +52,68 @@ namespace nova {
 		AddAction(menu->menuAction());
 	}
 	
+	bool ActionGroup::RemoveAction(QAction* action) {
+		const int position = actions.indexOf(action);
+		if (position == -1) return false;
+		
+		const bool is_important_action = important_list[position];
+		if ((provider != nullptr) && (position < num_shown)) {
+			// Important actions in front of the action and shown in total
+			int important_position = 0;
+			for (int i = 0 ; i < position ; ++i) {
+				if (important_list[i]) ++important_position;
+			}
+			int important_shown = important_position;
+			for (int i = position ; i < num_shown ; ++i) {
+				if (important_list[i]) ++important_shown;
+			}
+			
+			provider->HideActions(current_index - num_shown + position, 1,
+			                      (is_important_action ? current_index_important - important_shown + important_position : -1),
+			                      (is_important_action ? 1 : 0));
+			
+			--num_shown;
+			--current_index;
+			--provider->max_index;
+			if (is_important_action) {
+				--current_index_important;
+				--provider->max_index_important;
+			}
+			
+			provider->ShiftGroups(my_index + 1, -1, (is_important_action ? -1 : 0));
+			
+			// The separators aren't needed anymore if no (important) action is shown, the next one adds them again
+			const bool is_last_important = is_important_action && (important_shown == 1);
+			if (is_last_important) important_action_shown = false;
+			
+			const bool hides_separator = (num_shown == 0) && has_separator;
+			const bool hides_important_separator = is_last_important && has_important_separator;
+			if (hides_separator || hides_important_separator) {
+				provider->HideActions(current_index - 1, (hides_separator ? 1 : 0),
+				                      (hides_important_separator ? current_index_important - 1 : -1),
+				                      (hides_important_separator ? 1 : 0));
+				
+				if (hides_separator) {
+					has_separator = false;
+					--current_index;
+					--provider->max_index;
+				}
+				if (hides_important_separator) {
+					has_important_separator = false;
+					--current_index_important;
+					--provider->max_index_important;
+				}
+				
+				provider->ShiftGroups(my_index + 1, (hides_separator ? -1 : 0), (hides_important_separator ? -1 : 0));
+			}
+		}
+		
+		actions.removeAt(position);
+		important_list.removeAt(position);
+		has_important_action = important_list.contains(true);
+		return true;
+	}
+	
 	void ActionGroup::ShowAllRemaining() {
 		if (actions.isEmpty()) return;
 		
@@ -58,6 +135,9 @@ namespace nova {
 			++provider->max_index_important;
 		}
 		
+		if (separator != -1) has_separator = true;
+		if (separator_important != -1) has_important_separator = true;
+		
 		if ((separator != -1) || (separator_important != -1)) {
 			provider->DisplaySeparators((separator != -1), separator,
 			                            (separator_important != -1), separator_important);
@@ -84,15 +164,18 @@ namespace nova {
 		provider->max_index += counter;
 		provider->max_index_important += counter_important;
 		
-		// Update other indexes
-		for (int i = my_index + 1 ; i < provider->groups.count() ; ++i) {
-			provider->groups[i]->current_index += counter;
-			provider->groups[i]->current_index_important += counter_important;
-		}
+		// Update other indexes (including the separators)
+		provider->ShiftGroups(my_index + 1, counter + ((separator != -1) ? 1 : 0),
+		                      counter_important + ((separator_important != -1) ? 1 : 0));
+	}
+	
+	void ActionGroup::SetUpdateCallback(const std::function<void(ActionGroup*)>& callback) {
+		update_callback = callback;
+		if (update_callback) update_callback(this);
 	}
 	
 	ActionProvider::ActionProvider(const QString& title):
-			title(title), max_index(0), max_index_important(0) {}
+			title(title), owner(nullptr), max_index(0), max_index_important(0), are_actions_outdated(false) {}
 	
 	ActionProvider::~ActionProvider() noexcept {
 		// Delete all assigned groups
@@ -104,9 +187,55 @@ namespace nova {
 	QAction* ActionProvider::ConstructAction(const QString& text) {
 		auto* action = new QAction(&object);
 		action->setText(text);
+		TrackUses(action);
 		return action;
 	}
 	
+	void ActionProvider::MigrateAction(QAction* action) {
+		action->setParent(&object);
+		TrackUses(action);
+	}
+	
+	void ActionProvider::TrackUses(QAction* action) {
+		// Actions migrated to another provider are recorded there
+		QObject::connect(action, &QAction::triggered, &object, [this, action]() {
+			if ((owner != nullptr) && (action->parent() == &object)) owner->get_usage_store()->RecordUse(title, action);
+		});
+	}
+	
+	void ActionProvider::SetUpdateCallback(QAction* action, const std::function<void(QAction*)>& callback) {
+		if (!callback) {
+			update_callbacks.remove(action);
+			return;
+		}
+		
+		// Deleted actions must not be updated
+		if (!update_callbacks.contains(action)) {
+			QObject::connect(action, &QObject::destroyed, &object, [this, action]() { update_callbacks.remove(action); });
+		}
+		
+		update_callbacks.insert(action, callback);
+		callback(action);
+	}
+	
+	void ActionProvider::UpdateActions() {
+		if (!are_actions_outdated) return;
+		are_actions_outdated = false;
+		
+		NOVA_TRACE_SCOPE("ActionProvider::UpdateActions");
+		
+		// Copies, since update functions may add or remove other ones
+		const QList<ActionGroup*> current_groups = groups;
+		for (ActionGroup* i : current_groups) {
+			if (i->update_callback) i->update_callback(i);
+		}
+		
+		const QHash<QAction*, std::function<void(QAction*)>> callbacks = update_callbacks;
+		for (auto i = callbacks.constBegin() ; i != callbacks.constEnd() ; ++i) {
+			i.value()(i.key());
+		}
+	}
+	
 	ActionGroup* ActionProvider::FindGroup(int id) const {
 		for (ActionGroup* i : groups) {
 			if (i->get_id() == id) return i;
@@ -134,6 +263,37 @@ namespace nova {
 		return group;
 	}
 	
+	void ActionProvider::RemoveActionGroup(ActionGroup* group) {
+		if (group->provider != this) return;
+		
+		int important_shown = 0;
+		for (int i = 0 ; i < group->num_shown ; ++i) {
+			if (group->important_list[i]) ++important_shown;
+		}
+		
+		const int count = group->num_shown + (group->has_separator ? 1 : 0);
+		const int important_count = important_shown + (group->has_important_separator ? 1 : 0);
+		HideActions(group->current_index - count, count, group->current_index_important - important_count, important_count);
+		
+		max_index -= count;
+		max_index_important -= important_count;
+		
+		groups.removeAt(group->my_index);
+		for (int i = group->my_index ; i < groups.count() ; ++i) {
+			--groups[i]->my_index;
+		}
+		ShiftGroups(group->my_index, -count, -important_count);
+		
+		delete group;
+	}
+	
+	void ActionProvider::ShiftGroups(int first_group, int offset, int important_offset) {
+		for (int i = first_group ; i < groups.count() ; ++i) {
+			groups[i]->current_index += offset;
+			groups[i]->current_index_important += important_offset;
+		}
+	}
+	
 	void TempActionProvider::ClearActions() {
 		for (const QAction* i : ListActions()) {
 			delete i;
@@ -146,7 +306,15 @@ namespace nova {
 		setTitle(title);
 		if (tool_bar != nullptr) {
 			tool_bar->setIconSize(QSize(16, 16));
+			connect(tool_bar, &QToolBar::visibilityChanged, this, [this](bool visible) { if (visible) UpdateActions(); });
 		}
+		
+		// The actions are updated before the menu appears
+		connect(this, &QMenu::aboutToShow, this, [this]() { UpdateActions(); });
+	}
+	
+	bool MenuActionProvider::is_displayed() const {
+		return isVisible() || ((tool_bar != nullptr) && tool_bar->isVisible());
 	}
 	
 	MenuActionProvider* MenuActionProvider::ConstructSubMenu(const QString& title, Workbench* window) {
@@ -179,6 +347,11 @@ namespace nova {
 		}
 	}
 	
+	void MenuActionProvider::HideActions(int index, int count, int important_actions_index, int important_count) {
+		HideWidgetActions(this, index, count);
+		if (tool_bar != nullptr) HideWidgetActions(tool_bar, important_actions_index, important_count);
+	}
+	
 	void MenuActionProvider::ConstructNavigationAction(ActionProvider* provider) {
 		if (tool_bar != nullptr) {
 			QAction* action = provider->ConstructAction(get_title());
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#include "iconcache.h"
+
+#include <QtGlobal>
+#include <QtVersionChecks>
+#include <QHash>
+#include <QCache>
+#include <QApplication>
+
+namespace {
+	struct PixmapKey {
+		qint64 icon;
+		int width;
+		int height;
+		int device_pixel_ratio;  // In percent
+		int mode;
+		
+		bool operator==(const PixmapKey& other) const {
+			return (icon == other.icon) && (width == other.width) && (height == other.height)
+			       && (device_pixel_ratio == other.device_pixel_ratio) && (mode == other.mode);
+		}
+	};
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+	size_t qHash(const PixmapKey& key, size_t seed = 0) {
+#else
+	uint qHash(const PixmapKey& key, uint seed = 0) {
+#endif
+		return ::qHash(key.icon, seed) ^ ::qHash((key.width << 16) | key.height, seed)
+		       ^ ::qHash((key.device_pixel_ratio << 4) | key.mode, seed);
+	}
+	
+	// The costs are measured in kilobytes
+	QCache<PixmapKey, QPixmap> pixmaps(2048);
+	QCache<PixmapKey, QIcon> icons(2048);
+	QHash<int, QIcon> standard_icons;
+	
+	// Pixmaps must be destroyed before QApplication
+	void RegisterCleanup() {
+		static const bool is_registered = []() {
+			qAddPostRoutine(nova::IconCache::Clear);
+			return true;
+		}();
+		Q_UNUSED(is_registered)
+	}
+	
+	PixmapKey CreateKey(const QIcon& icon, const QSize& size, QIcon::Mode mode) {
+		return {icon.cacheKey(), size.width(), size.height(), qRound(qApp->devicePixelRatio() * 100), mode};
+	}
+	
+	int CalculateCost(const QPixmap& pixmap) {
+		return qMax(1, pixmap.width() * pixmap.height() * pixmap.depth() / 8 / 1024);
+	}
+}
+
+namespace nova {
+	QPixmap IconCache::Pixmap(const QIcon& icon, const QSize& size, QIcon::Mode mode) {
+		if (icon.isNull()) return QPixmap();
+		
+		const PixmapKey key = CreateKey(icon, size, mode);
+		if (const QPixmap* pixmap = pixmaps.object(key)) return *pixmap;
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+		const QPixmap pixmap = icon.pixmap(size, qApp->devicePixelRatio(), mode);
+#else
+		const QPixmap pixmap = icon.pixmap(size, mode);
+#endif
+		
+		RegisterCleanup();
+		pixmaps.insert(key, new QPixmap(pixmap), CalculateCost(pixmap));
+		return pixmap;
+	}
+	
+	QIcon IconCache::Icon(const QIcon& icon, const QSize& size) {
+		if (icon.isNull()) return QIcon();
+		
+		const PixmapKey key = CreateKey(icon, size, QIcon::Normal);
+		if (const QIcon* cached_icon = icons.object(key)) return *cached_icon;
+		
+		// The disabled and selected modes are derived from the pixmap by the style when needed
+		const QPixmap pixmap = Pixmap(icon, size);
+		const QIcon cached_icon(pixmap);
+		
+		icons.insert(key, new QIcon(cached_icon), CalculateCost(pixmap));
+		return cached_icon;
+	}
+	
+	QIcon IconCache::StandardIcon(QStyle::StandardPixmap standard_pixmap) {
+		auto iterator = standard_icons.find(standard_pixmap);
+		if (iterator == standard_icons.end()) {
+			RegisterCleanup();
+			iterator = standard_icons.insert(standard_pixmap, QApplication::style()->standardIcon(standard_pixmap));
+		}
+		
+		return iterator.value();
+	}
+	
+	int IconCache::get_max_cost() {
+		return pixmaps.maxCost();
+	}
+	
+	void IconCache::set_max_cost(int kilobytes) {
+		pixmaps.setMaxCost(kilobytes);
+		icons.setMaxCost(kilobytes);
+	}
+	
+	void IconCache::Clear() {
+		pixmaps.clear();
+		icons.clear();
+		standard_icons.clear();
+	}
+}
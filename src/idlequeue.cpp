@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#include "idlequeue.h"
+
+#include "trace.h"
+
+namespace nova {
+	IdleQueue::IdleQueue():
+			sequence(0), id_counter(0), frame_budget(4), total_latency(0) {
+		// A zero timer times out when all pending events have been processed
+		timer.setSingleShot(true);
+		timer.setInterval(0);
+		QObject::connect(&timer, &QTimer::timeout, [this]() { RunSlice(); });
+		
+		clock.start();
+	}
+	
+	int IdleQueue::Post(const std::function<void()>& job, int priority, const QString& key) {
+		if (!key.isEmpty()) {
+			const auto key_iterator = keys.constFind(key);
+			if (key_iterator != keys.constEnd()) {
+				const int id = key_iterator.value();
+				auto iterator = jobs.find(positions.value(id));
+				
+				Job replacement = iterator->second;
+				replacement.function = job;
+				jobs.erase(iterator);
+				
+				const Position position(-priority, sequence++);
+				jobs.emplace(position, replacement);
+				positions.insert(id, position);
+				
+				++metrics.deduplicated_count;
+				return id;
+			}
+		}
+		
+		const int id = ++id_counter;
+		const Position position(-priority, sequence++);
+		jobs.emplace(position, Job{id, key, job, clock.nsecsElapsed()});
+		positions.insert(id, position);
+		if (!key.isEmpty()) keys.insert(key, id);
+		
+		if (!timer.isActive()) timer.start();
+		return id;
+	}
+	
+	bool IdleQueue::Cancel(int id) {
+		const auto position_iterator = positions.constFind(id);
+		if (position_iterator == positions.constEnd()) return false;
+		
+		auto iterator = jobs.find(position_iterator.value());
+		if (!iterator->second.key.isEmpty()) keys.remove(iterator->second.key);
+		positions.erase(position_iterator);
+		jobs.erase(iterator);
+		
+		++metrics.cancelled_count;
+		if (jobs.empty()) timer.stop();
+		return true;
+	}
+	
+	bool IdleQueue::Cancel(const QString& key) {
+		const auto iterator = keys.constFind(key);
+		return (iterator != keys.constEnd()) && Cancel(iterator.value());
+	}
+	
+	bool IdleQueue::Flush(const QString& key) {
+		const auto key_iterator = keys.constFind(key);
+		if (key_iterator == keys.constEnd()) return false;
+		
+		Run(jobs.find(positions.value(key_iterator.value())));
+		if (jobs.empty()) timer.stop();
+		return true;
+	}
+	
+	void IdleQueue::Clear() {
+		metrics.cancelled_count += jobs.size();
+		
+		jobs.clear();
+		positions.clear();
+		keys.clear();
+		timer.stop();
+	}
+	
+	void IdleQueue::ResetMetrics() {
+		metrics = IdleQueueMetrics();
+		total_latency = 0;
+	}
+	
+	void IdleQueue::Run(std::map<Position, Job>::iterator iterator) {
+		// The job is removed before running it, so that it can post itself again
+		const Job job = iterator->second;
+		positions.remove(job.id);
+		if (!job.key.isEmpty()) keys.remove(job.key);
+		jobs.erase(iterator);
+		
+		const qint64 latency = clock.nsecsElapsed() - job.post_time;
+		++metrics.run_count;
+		total_latency += latency;
+		metrics.mean_latency = total_latency / static_cast<qint64>(metrics.run_count);
+		metrics.max_latency = qMax(metrics.max_latency, latency);
+		
+		job.function();
+	}
+	
+	void IdleQueue::RunSlice() {
+		NOVA_TRACE_SCOPE("IdleQueue::RunSlice");
+		
+		const qint64 start = clock.nsecsElapsed();
+		const qint64 budget = static_cast<qint64>(frame_budget) * 1000000;
+		
+		do {
+			Run(jobs.begin());
+		} while (!jobs.empty() && (clock.nsecsElapsed() - start < budget));
+		
+		metrics.max_slice_duration = qMax(metrics.max_slice_duration, clock.nsecsElapsed() - start);
+		
+		// Events are processed before the next slice
+		if (!jobs.empty()) timer.start();
+	}
+}
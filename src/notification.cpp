@@ -10,6 +10,9 @@
 #include <QStyle>
 #include <QApplication>
 
+#include "iconcache.h"
+#include "translations.h"
+
 #define NOVA_CONTEXT "nova/notification"
 
 namespace nova {
@@ -17,7 +20,7 @@ namespace nova {
 	                           NotificationType type, bool high_priority, const ActionList& actions):
 			notifier(notifier), title(title), message(message), type(type),
 			high_priority(high_priority), actions(actions) {
-		this->actions.insert(NOVA_TR("Close"), [](Notification* notification) {
+		this->actions.insert(NOVA_TR_CACHED(Notification_Close), [](Notification* notification) {
 			notification->Close();
 		});
 	}
@@ -37,7 +40,7 @@ namespace nova {
 				pixmap = QStyle::SP_MessageBoxCritical;
 		}
 		
-		return QApplication::style()->standardIcon(pixmap);
+		return IconCache::StandardIcon(pixmap);
 	}
 	
 	QString Notification::CreateLinksLabelText() const {
@@ -0,0 +1,696 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#include "plugin.h"
+
+#include <functional>
+
+#include <QtGlobal>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QPluginLoader>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QLoggingCategory>
+#include <QDebug>
+#include <QApplication>
+#include <QEvent>
+#include <QAction>
+#include <QIcon>
+#include <QIconEngine>
+#include <QPainter>
+#include <QPixmap>
+#include <QRect>
+#include <QSize>
+#include <QKeySequence>
+
+#include "workbench.h"
+#include "notification.h"
+#include "actionprovider.h"
+#include "registrationqueue.h"
+#include "toolwindow.h"
+#include "settings.h"
+#include "trace.h"
+
+#define NOVA_CONTEXT "nova/plugin"
+
+Q_LOGGING_CATEGORY(nova_plugins, "nova.plugins", QtWarningMsg)
+
+namespace {
+	// Looks up or decodes the icon of a declared action when it's used the first time, e.g. when its menu is shown
+	class DeferredIconEngine : public QIconEngine {
+		public:
+			inline explicit DeferredIconEngine(const QString& source):
+					source(source), is_loaded(false) {}
+			
+			inline void paint(QPainter* painter, const QRect& rect, QIcon::Mode mode, QIcon::State state) override {
+				Icon().paint(painter, rect, Qt::AlignCenter, mode, state);
+			}
+			
+			inline QPixmap pixmap(const QSize& size, QIcon::Mode mode, QIcon::State state) override {
+				return Icon().pixmap(size, mode, state);
+			}
+			
+			inline QSize actualSize(const QSize& size, QIcon::Mode mode, QIcon::State state) override {
+				return Icon().actualSize(size, mode, state);
+			}
+			
+			inline QIconEngine* clone() const override {
+				auto* engine = new DeferredIconEngine(source);
+				engine->icon = icon;
+				engine->is_loaded = is_loaded;
+				return engine;
+			}
+			
+			inline QString key() const override { return "nova_deferred"; }
+		
+		private:
+			const QString source;  // A file or resource path, theme icons are prefixed with "theme:"
+			QIcon icon;
+			bool is_loaded;
+			
+			const QIcon& Icon() {
+				if (!is_loaded) {
+					icon = source.startsWith("theme:") ? QIcon::fromTheme(source.mid(6)) : QIcon(source);
+					is_loaded = true;
+				}
+				
+				return icon;
+			}
+	};
+}
+
+namespace nova {
+	PluginManager::PluginManager(Workbench* window):
+			QObject(window), window(window), other_actions(nullptr), background(nullptr) {
+		// Initializing is mostly I/O bound (loading libraries), so all cores can be used
+		pool.setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+	}
+	
+	PluginManager::~PluginManager() noexcept {
+		pool.waitForDone();
+		delete background;
+		
+		// The libraries stay loaded, their code may still be referenced (e.g. by deleted widgets' vtables)
+		qDeleteAll(plugins);
+		delete other_actions;
+	}
+	
+	int PluginManager::LoadPlugins(const QString& directory) {
+		NOVA_TRACE_SCOPE("PluginManager::LoadPlugins");
+		
+		WaitForBackgroundActivation();
+		
+		QList<PluginInfo*> requested;
+		const QFileInfoList manifests = QDir(directory).entryInfoList({"*.json"}, QDir::Files, QDir::Name);
+		for (const QFileInfo& i : manifests) {
+			PluginInfo* info = ReadManifest(i.absoluteFilePath());
+			if ((info != nullptr) && !info->is_lazy) requested << info;
+		}
+		
+		const QList<PluginInfo*> ordered = ResolveDependencies(requested);
+		InitializePlugins(ordered);
+		ActivatePlugins(ordered);
+		
+		int count = 0;
+		for (const PluginInfo* i : ordered) {
+			if (i->is_active) count++;
+		}
+		return count;
+	}
+	
+	bool PluginManager::ActivatePlugin(const QString& name) {
+		PluginInfo* info = plugins_by_name.value(name, nullptr);
+		if (info == nullptr) return false;
+		if (info->is_active) return true;
+		
+		NOVA_TRACE_SCOPE("PluginManager::ActivatePlugin");
+		
+		WaitForBackgroundActivation();
+		if (info->is_active) return true;
+		
+		const QList<PluginInfo*> ordered = ResolveDependencies({info});
+		InitializePlugins(ordered);
+		ActivatePlugins(ordered);
+		return info->is_active;
+	}
+	
+	bool PluginManager::UnloadPlugin(const QString& name) {
+		WaitForBackgroundActivation();
+		
+		PluginInfo* info = plugins_by_name.value(name, nullptr);
+		if ((info == nullptr) || !info->is_active) return false;
+		
+		NOVA_TRACE_SCOPE("PluginManager::UnloadPlugin");
+		
+		QElapsedTimer timer;
+		timer.start();
+		
+		QList<PluginInfo*> unloaded;
+		UnloadPlugins(info, unloaded);
+		
+		qCDebug(nova_plugins).nospace() << "Unloaded " << unloaded.count() << " plugins in " << timer.elapsed() << " ms";
+		return true;
+	}
+	
+	bool PluginManager::ReloadPlugin(const QString& name) {
+		WaitForBackgroundActivation();
+		
+		PluginInfo* info = plugins_by_name.value(name, nullptr);
+		if ((info == nullptr) || !info->is_active) return false;
+		
+		NOVA_TRACE_SCOPE("PluginManager::ReloadPlugin");
+		
+		QElapsedTimer timer;
+		timer.start();
+		
+		QList<PluginInfo*> unloaded;
+		UnloadPlugins(info, unloaded);
+		
+		const QList<PluginInfo*> ordered = ResolveDependencies(unloaded);
+		InitializePlugins(ordered);
+		ActivatePlugins(ordered);
+		
+		qCDebug(nova_plugins).nospace() << "Reloaded " << unloaded.count() << " plugins in " << timer.elapsed() << " ms";
+		return info->is_active;
+	}
+	
+	QStringList PluginManager::get_plugins() const {
+		QStringList names;
+		for (const PluginInfo* i : plugins) names << i->name;
+		return names;
+	}
+	
+	bool PluginManager::is_active(const QString& name) const {
+		const PluginInfo* info = plugins_by_name.value(name, nullptr);
+		return (info != nullptr) && info->is_active;
+	}
+	
+	Plugin* PluginManager::get_plugin(const QString& name) const {
+		const PluginInfo* info = plugins_by_name.value(name, nullptr);
+		return (info == nullptr) ? nullptr : info->instance;
+	}
+	
+	QJsonObject PluginManager::get_manifest(const QString& name) const {
+		const PluginInfo* info = plugins_by_name.value(name, nullptr);
+		return (info == nullptr) ? QJsonObject() : info->manifest;
+	}
+	
+	PluginManager::PluginInfo* PluginManager::ReadManifest(const QString& file_name) {
+		QFile file(file_name);
+		if (!file.open(QIODevice::ReadOnly)) {
+			qCWarning(nova_plugins).nospace() << "Can't read the manifest \"" << file_name << "\"";
+			return nullptr;
+		}
+		
+		// The manifest is mapped instead of copied, the parser reads it only once
+		const qint64 size = file.size();
+		uchar* data = file.map(0, size);
+		const QByteArray content = (data == nullptr) ? file.readAll()
+		                                             : QByteArray::fromRawData(reinterpret_cast<const char*>(data), size);
+		
+		QJsonParseError error;
+		const QJsonDocument document = QJsonDocument::fromJson(content, &error);
+		if (data != nullptr) file.unmap(data);
+		
+		const QJsonObject manifest = document.object();
+		const QString name = manifest.value("name").toString();
+		const QString library = manifest.value("library").toString();
+		
+		if ((error.error != QJsonParseError::NoError) || name.isEmpty() || library.isEmpty()) {
+			qCWarning(nova_plugins).nospace() << "The manifest \"" << file_name << "\" is invalid";
+			return nullptr;
+		}
+		
+		// The first plugin wins, e.g. if a plugin has been installed twice
+		if (plugins_by_name.contains(name)) {
+			qCWarning(nova_plugins).nospace() << "The plugin \"" << name << "\" of \"" << file_name << "\" is already known";
+			return nullptr;
+		}
+		
+		auto* info = new PluginInfo();
+		info->name = name;
+		info->manifest = manifest;
+		info->is_lazy = manifest.value("lazy").toBool(false);
+		for (const QJsonValue& i : manifest.value("dependencies").toArray()) {
+			info->dependencies << i.toString();
+		}
+		
+		// The library isn't loaded yet
+		info->loader = new QPluginLoader(QFileInfo(file_name).dir().absoluteFilePath(library), this);
+		
+		plugins << info;
+		plugins_by_name.insert(name, info);
+		
+		ConstructActions(info);
+		return info;
+	}
+	
+	void PluginManager::ConstructActions(PluginInfo* info) {
+		for (const QJsonValue& i : info->manifest.value("actions").toArray()) {
+			const QJsonObject declaration = i.toObject();
+			const QString id = declaration.value("id").toString();
+			if (id.isEmpty() || actions.contains(id)) {
+				qCWarning(nova_plugins).nospace() << "The plugin \"" << info->name << "\" declares an action without a unique id";
+				continue;
+			}
+			
+			ActionProvider* provider = FindProvider(declaration.value("provider").toString());
+			const bool is_shown = (provider != nullptr);
+			if (!is_shown) {
+				if (other_actions == nullptr) {
+					other_actions = new ActionProvider(NOVA_TR("Plugins"));
+					window->RegisterActionProvider(other_actions);
+				}
+				provider = other_actions;
+			}
+			
+			QAction* action = provider->ConstructAction(declaration.value("text").toString());
+			action->setObjectName(id);
+			action->setToolTip(declaration.value("tooltip").toString());
+			
+			const QString shortcut = declaration.value("shortcut").toString();
+			if (!shortcut.isEmpty()) action->setShortcut(QKeySequence(shortcut, QKeySequence::PortableText));
+			
+			// QIcon decodes raster files immediately, so the icon is only loaded when it's needed
+			const QString icon = declaration.value("icon").toString();
+			if (!icon.isEmpty()) action->setIcon(QIcon(new DeferredIconEngine(icon)));
+			
+			if (is_shown) {
+				ActionGroup* group = declaration.contains("group") ? provider->FindGroup(declaration.value("group").toInt()) : nullptr;
+				if (group == nullptr) provider->ShowAction(action);
+				else group->AddAction(action);
+			}
+			
+			// The first trigger loads the plugin, which connects to the action in Activate()
+			connect(action, &QAction::triggered, this, [this, info, action]() {
+				if (!info->is_active) RequestActivation(info, action);
+			});
+			
+			info->actions << action;
+			actions.insert(id, action);
+		}
+	}
+	
+	ActionProvider* PluginManager::FindProvider(const QString& provider) {
+		if (provider.isEmpty()) return nullptr;
+		
+		static const QHash<QString, Workbench::StandardMenu> standard_menus = {
+			{"menu:file", Workbench::Menu_File},
+			{"menu:edit", Workbench::Menu_Edit},
+			{"menu:window", Workbench::Menu_Window},
+			{"menu:help", Workbench::Menu_Help}
+		};
+		
+		const auto iterator = standard_menus.find(provider);
+		if (iterator != standard_menus.end()) return window->get_standard_menu(iterator.value());
+		
+		return window->FindActionProvider(provider);
+	}
+	
+	QList<PluginManager::PluginInfo*> PluginManager::ResolveDependencies(const QList<PluginInfo*>& requested) {
+		QList<PluginInfo*> ordered;
+		QSet<PluginInfo*> visited;
+		QSet<PluginInfo*> visiting;
+		
+		// Depth-first search, dependencies are added before the plugins depending on them
+		std::function<bool(PluginInfo*)> visit = [&](PluginInfo* info) -> bool {
+			if (info->is_active) return true;
+			if (visited.contains(info)) return info->error.isEmpty();
+			
+			if (visiting.contains(info)) {
+				info->error = NOVA_TR("The dependencies are cyclic.");
+				return false;
+			}
+			
+			// Each attempt starts over, e.g. a previous one might have failed while the library was being rebuilt
+			info->error.clear();
+			
+			visiting.insert(info);
+			for (const QString& i : info->dependencies) {
+				PluginInfo* dependency = plugins_by_name.value(i, nullptr);
+				if (dependency == nullptr) {
+					info->error = NOVA_TR("The dependency \"%1\" is missing.").arg(i);
+				} else if (!visit(dependency)) {
+					if (info->error.isEmpty()) info->error = NOVA_TR("The dependency \"%1\" can't be loaded.").arg(i);
+				}
+				if (!info->error.isEmpty()) break;
+			}
+			visiting.remove(info);
+			visited.insert(info);
+			
+			// Failed plugins are kept, so that their errors are reported
+			ordered << info;
+			return info->error.isEmpty();
+		};
+		
+		for (PluginInfo* i : requested) visit(i);
+		return ordered;
+	}
+	
+	QHash<PluginManager::PluginInfo*, int> PluginManager::ComputeLevels(const QList<PluginInfo*>& ordered, int& level_count) {
+		// The level of a plugin is the length of its longest dependency chain, plugins of the same level are independent
+		QHash<PluginInfo*, int> levels;
+		level_count = 0;
+		for (PluginInfo* i : ordered) {
+			int level = 0;
+			for (const QString& j : i->dependencies) {
+				PluginInfo* dependency = plugins_by_name.value(j, nullptr);
+				if (levels.contains(dependency)) level = qMax(level, levels.value(dependency) + 1);
+			}
+			levels.insert(i, level);
+			level_count = qMax(level_count, level + 1);
+		}
+		
+		return levels;
+	}
+	
+	int PluginManager::StartLevel(const QList<PluginInfo*>& ordered, const QHash<PluginInfo*, int>& levels, int level,
+	                              bool is_background) {
+		int count = 0;
+		for (PluginInfo* i : ordered) {
+			if ((levels.value(i) != level) || i->is_initialized || !i->error.isEmpty()) continue;
+			
+			// Skip plugins whose dependencies failed in a previous level
+			for (const QString& j : i->dependencies) {
+				if (!plugins_by_name.value(j)->is_initialized) {
+					i->error = NOVA_TR("The dependency \"%1\" can't be loaded.").arg(j);
+					break;
+				}
+			}
+			if (!i->error.isEmpty()) continue;
+			
+			// Each worker only accesses its own plugin, background workers report back to the GUI thread
+			if (is_background) {
+				pool.start([this, i]() {
+					InitializePlugin(i);
+					QMetaObject::invokeMethod(this, [this]() { BackgroundPluginInitialized(); }, Qt::QueuedConnection);
+				});
+			} else {
+				pool.start([i]() { InitializePlugin(i); });
+			}
+			++count;
+		}
+		
+		return count;
+	}
+	
+	void PluginManager::InitializePlugins(const QList<PluginInfo*>& ordered) {
+		NOVA_TRACE_SCOPE("PluginManager::InitializePlugins");
+		
+		int level_count;
+		const QHash<PluginInfo*, int> levels = ComputeLevels(ordered, level_count);
+		
+		QElapsedTimer timer;
+		timer.start();
+		
+		for (int level = 0 ; level < level_count ; ++level) {
+			StartLevel(ordered, levels, level, false);
+			pool.waitForDone();
+		}
+		
+		qCDebug(nova_plugins).nospace() << "Initialized " << ordered.count() << " plugins in " << level_count
+		                                << " levels in " << timer.elapsed() << " ms";
+	}
+	
+	bool PluginManager::ActivatePlugins(const QList<PluginInfo*>& ordered) {
+		NOVA_TRACE_SCOPE("PluginManager::ActivatePlugins");
+		
+		RegistrationQueue* queue = window->get_registration_queue();
+		queue->Commit();
+		
+		bool is_successful = true;
+		for (PluginInfo* i : ordered) {
+			if (i->is_initialized && !i->is_active) {
+				// The contributions are found by comparing the workbench's state, so that they can be removed later
+				const Snapshot snapshot = CreateSnapshot();
+				
+				// Contributions staged by Initialize() are available in Activate() and belong to the plugin
+				queue->Commit(i);
+				i->instance->Activate(window);
+				i->contributions = CompareSnapshot(snapshot);
+				i->is_active = true;
+				emit pluginActivated(i->name);
+			} else if (!i->is_active) {
+				is_successful = false;
+				
+				// The library has been unloaded, so the staged callbacks can't be called
+				queue->Discard(i);
+				
+				qCWarning(nova_plugins).nospace() << "The plugin \"" << i->name << "\" can't be loaded: " << i->error;
+				window->ShowNotification(NOVA_TR("Plugins"),
+				                         NOVA_TR("The plugin \"%1\" can't be loaded: %2").arg(i->name, i->error),
+				                         Notification::Error);
+			}
+		}
+		
+		return is_successful;
+	}
+	
+	void PluginManager::RequestActivation(PluginInfo* info, QAction* action) {
+		// Triggering the action again while the plugin is being loaded doesn't do anything
+		if ((background != nullptr) && (background->info == info)) return;
+		for (const auto& i : activation_requests) {
+			if (i.first == info) return;
+		}
+		
+		activation_requests << qMakePair(info, QPointer<QAction>(action));
+		if (background == nullptr) StartNextActivation();
+	}
+	
+	void PluginManager::StartNextActivation() {
+		while ((background == nullptr) && !activation_requests.isEmpty()) {
+			const QPair<PluginInfo*, QPointer<QAction>> request = activation_requests.takeFirst();
+			
+			// Activated meanwhile, e.g. as a dependency
+			if (request.first->is_active) {
+				if (!request.second.isNull()) request.second->trigger();
+				continue;
+			}
+			
+			background = new BackgroundActivation{request.first, request.second, ResolveDependencies({request.first}),
+			                                      QHash<PluginInfo*, int>(), 0, 0, 0};
+			background->levels = ComputeLevels(background->ordered, background->level_count);
+			StartBackgroundLevel();
+		}
+	}
+	
+	void PluginManager::StartBackgroundLevel() {
+		// Levels without plugins to be initialized are skipped
+		while (background->level < background->level_count) {
+			background->remaining = StartLevel(background->ordered, background->levels, background->level, true);
+			if (background->remaining > 0) return;
+			++background->level;
+		}
+		
+		BackgroundActivation* activation = background;
+		background = nullptr;
+		
+		// Slots connected while the signal was emitted haven't been called, so the action is triggered again
+		ActivatePlugins(activation->ordered);
+		if (activation->info->is_active && !activation->action.isNull()) activation->action->trigger();
+		delete activation;
+		
+		StartNextActivation();
+	}
+	
+	void PluginManager::BackgroundPluginInitialized() {
+		if ((background == nullptr) || (--background->remaining > 0)) return;
+		
+		++background->level;
+		StartBackgroundLevel();
+	}
+	
+	void PluginManager::WaitForBackgroundActivation() {
+		// The workers report each initialized plugin by a queued call, which continues the activation
+		while (background != nullptr) {
+			pool.waitForDone();
+			QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+		}
+	}
+	
+	void PluginManager::UnloadPlugins(PluginInfo* info, QList<PluginInfo*>& unloaded) {
+		// The plugins depending on this one are unloaded first
+		for (PluginInfo* i : plugins) {
+			if (i->is_active && i->dependencies.contains(info->name)) UnloadPlugins(i, unloaded);
+		}
+		
+		info->instance->Deactivate(window);
+		RemoveContributions(info->contributions);
+		info->contributions = Contributions();
+		
+		// Objects which are deleted later could still need the library's code
+		QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+		
+		// Deletes the plugin's instance
+		if (!info->loader->unload()) {
+			qCDebug(nova_plugins).nospace() << "The library of \"" << info->name << "\" stays loaded: " << info->loader->errorString();
+		}
+		
+		info->instance = nullptr;
+		info->is_initialized = false;
+		info->is_active = false;
+		unloaded.prepend(info);  // Dependencies first
+		
+		emit pluginUnloaded(info->name);
+	}
+	
+	PluginManager::Snapshot PluginManager::CreateSnapshot() const {
+		Snapshot snapshot;
+		for (ToolWindow* i : window->get_tool_windows()) snapshot.tool_windows.insert(i);
+		for (ToolWindowPlaceholder* i : window->get_tool_window_placeholders()) snapshot.placeholders.insert(i);
+		for (SettingsPage* i : window->get_settings_pages()) snapshot.settings_pages.insert(i);
+		for (QWidget* i : window->get_status_bar_widgets()) snapshot.status_bar_widgets.insert(i);
+		for (SearchContributor* i : window->get_search_contributors()) snapshot.search_contributors.insert(i);
+		
+		for (ActionProvider* i : window->get_action_providers()) {
+			snapshot.providers.insert(i);
+			
+			const QList<QAction*> actions = i->ListActions();
+			snapshot.actions.insert(i, QSet<QAction*>(actions.begin(), actions.end()));
+			for (ActionGroup* j : i->ListGroups()) {
+				const QList<QAction*> grouped_actions = j->ListActions();
+				snapshot.grouped_actions.insert(j, QSet<QAction*>(grouped_actions.begin(), grouped_actions.end()));
+			}
+		}
+		
+		return snapshot;
+	}
+	
+	PluginManager::Contributions PluginManager::CompareSnapshot(const Snapshot& snapshot) const {
+		Contributions contributions;
+		for (ToolWindow* i : window->get_tool_windows()) {
+			if (!snapshot.tool_windows.contains(i)) contributions.tool_windows << i;
+		}
+		for (ToolWindowPlaceholder* i : window->get_tool_window_placeholders()) {
+			if (!snapshot.placeholders.contains(i)) contributions.placeholders << i;
+		}
+		for (SettingsPage* i : window->get_settings_pages()) {
+			if (!snapshot.settings_pages.contains(i)) contributions.settings_pages << i;
+		}
+		for (QWidget* i : window->get_status_bar_widgets()) {
+			if (!snapshot.status_bar_widgets.contains(i)) contributions.status_bar_widgets << i;
+		}
+		for (SearchContributor* i : window->get_search_contributors()) {
+			if (!snapshot.search_contributors.contains(i)) contributions.search_contributors << i;
+		}
+		
+		// Tool windows and settings pages are removed separately
+		QSet<ActionProvider*> removed_separately;
+		for (ToolWindow* i : contributions.tool_windows) removed_separately.insert(i);
+		for (SettingsPage* i : contributions.settings_pages) removed_separately.insert(i);
+		
+		for (ActionProvider* i : window->get_action_providers()) {
+			if (!snapshot.providers.contains(i)) {
+				if (!removed_separately.contains(i)) contributions.providers << i;
+				continue;
+			}
+			
+			for (ActionGroup* j : i->ListGroups()) {
+				const auto iterator = snapshot.grouped_actions.find(j);
+				if (iterator == snapshot.grouped_actions.end()) {
+					contributions.groups << qMakePair(i, j->get_id());
+					continue;
+				}
+				
+				for (QAction* k : j->ListActions()) {
+					if (!iterator.value().contains(k)) contributions.grouped_actions << qMakePair(qMakePair(i, j->get_id()), QPointer<QAction>(k));
+				}
+			}
+			
+			const QSet<QAction*>& actions = snapshot.actions[i];
+			for (QAction* j : i->ListActions()) {
+				if (!actions.contains(j)) contributions.actions << j;
+			}
+		}
+		
+		return contributions;
+	}
+	
+	void PluginManager::RemoveContributions(const Contributions& contributions) {
+		const QList<ActionProvider*> providers = window->get_action_providers();
+		
+		// Waits for running searches, before the plugin's code is unloaded
+		for (SearchContributor* i : contributions.search_contributors) window->UnregisterSearchContributor(i);
+		
+		for (const auto& i : contributions.grouped_actions) {
+			if (i.second.isNull() || !providers.contains(i.first.first)) continue;
+			
+			ActionGroup* group = i.first.first->FindGroup(i.first.second);
+			if (group != nullptr) group->RemoveAction(i.second);
+		}
+		
+		for (const auto& i : contributions.groups) {
+			if (!providers.contains(i.first)) continue;
+			
+			ActionGroup* group = i.first->FindGroup(i.second);
+			if (group != nullptr) i.first->RemoveActionGroup(group);
+		}
+		
+		// Also deletes their navigation actions
+		for (ToolWindowPlaceholder* i : contributions.placeholders) window->UnregisterToolWindow(i);
+		for (ToolWindow* i : contributions.tool_windows) window->UnregisterToolWindow(i);
+		for (SettingsPage* i : contributions.settings_pages) window->UnregisterSettingsPage(i);
+		for (QWidget* i : contributions.status_bar_widgets) window->RemoveStatusBarWidget(i);
+		
+		for (const QPointer<QAction>& i : contributions.actions) {
+			delete i.data();
+		}
+		
+		// Menus belong to the workbench and staged providers to the queue, other providers to the plugin
+		for (ActionProvider* i : contributions.providers) {
+			if (!window->get_action_providers().contains(i)) continue;
+			
+			window->UnregisterActionProvider(i);
+			if (auto* menu = dynamic_cast<MenuActionProvider*>(i)) {
+				delete menu->get_tool_bar();
+				delete menu;
+			} else {
+				window->get_registration_queue()->DeleteProvider(i);
+			}
+		}
+	}
+	
+	void PluginManager::InitializePlugin(PluginInfo* info) {
+		NOVA_TRACE_SCOPE("PluginManager::InitializePlugin");
+		
+		if (!info->loader->load()) {
+			info->error = info->loader->errorString();
+			return;
+		}
+		
+		QObject* root = info->loader->instance();
+		info->instance = qobject_cast<Plugin*>(root);
+		if (info->instance == nullptr) {
+			info->error = NOVA_TR("The library doesn't contain a Nova plugin.");
+			info->loader->unload();
+			return;
+		}
+		
+		// The root object has been created on this worker thread, but it's used on the GUI thread
+		root->moveToThread(QApplication::instance()->thread());
+		
+		// Descriptions staged on this thread belong to the plugin
+		RegistrationQueue::SetStagingOwner(info);
+		const bool is_initialized = info->instance->Initialize();
+		RegistrationQueue::SetStagingOwner(nullptr);
+		
+		if (!is_initialized) {
+			info->error = NOVA_TR("The initialization failed.");
+			
+			// The next attempt loads the library again
+			info->instance = nullptr;
+			info->loader->unload();
+			return;
+		}
+		
+		info->is_initialized = true;
+	}
+}
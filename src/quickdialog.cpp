@@ -5,6 +5,9 @@
 
 #include "quickdialog.h"
 
+#include <memory>
+#include <algorithm>
+
 #include <Qt>
 #include <QObject>
 #include <QString>
@@ -12,13 +15,176 @@
 #include <QRect>
 #include <QIcon>
 #include <QKeyEvent>
-#include <QListWidget>
-#include <QListWidgetItem>
+#include <QHideEvent>
+#include <QVector>
+#include <QVariant>
+#include <QStringView>
+#include <QFontMetrics>
+#include <QModelIndex>
+#include <QAbstractListModel>
+#include <QListView>
+#include <QVBoxLayout>
+#include <QApplication>
 #include <QDockWidget>
+#include <QLayout>
 
 #include "ui_quickdialog.h"
+#include "iconcache.h"
+
+// Object names of the reusable dialogs, which are children of their parent window
+#define NOVA_TEXT_DIALOG "novaQuickDialogText"
+#define NOVA_ITEM_DIALOG "novaQuickDialogItem"
+
+// Maximum count of rows the item dialog displays at once
+#define NOVA_MAX_VISIBLE_ITEMS 15
 
 namespace nova {
+	// Model of the item dialog, which only requests the visible items from the sources
+	class ItemListModel : public QAbstractListModel {
+		public:
+			explicit ItemListModel(QObject* parent):
+					QAbstractListModel(parent), count(0) {}
+			
+			void Reset(int count, const std::function<QString(int)>& text_source,
+			           const std::function<QIcon(int)>& icon_source) {
+				beginResetModel();
+				this->count = count;
+				this->text_source = text_source;
+				this->icon_source = icon_source;
+				filter.clear();
+				rows.clear();
+				buffer.clear();
+				offsets.clear();
+				endResetModel();
+			}
+			
+			void SetFilter(const QString& filter) {
+				const QString new_filter = filter.toLower();
+				if (new_filter == this->filter) return;
+				
+				beginResetModel();
+				
+				if (new_filter.isEmpty()) {
+					rows.clear();
+				} else {
+					if (buffer.isEmpty() && (count > 0)) BuildBuffer();
+					
+					// Extending the filter only removes rows
+					if (!this->filter.isEmpty() && new_filter.startsWith(this->filter)) {
+						QVector<int> remaining_rows;
+						for (int i : rows) {
+							if (Text(i).contains(new_filter)) remaining_rows << i;
+						}
+						rows.swap(remaining_rows);
+					} else {
+						rows.clear();
+						
+						// Search the whole buffer at once and jump to the next item after each match
+						int position = buffer.indexOf(new_filter);
+						while (position != -1) {
+							const int row = static_cast<int>(std::upper_bound(offsets.cbegin(), offsets.cend(), position)
+							                                 - offsets.cbegin()) - 1;
+							rows << row;
+							
+							if (row + 1 >= count) break;
+							position = buffer.indexOf(new_filter, offsets[row + 1]);
+						}
+					}
+				}
+				
+				this->filter = new_filter;
+				endResetModel();
+			}
+			
+			int SourceRow(int row) const {
+				return filter.isEmpty() ? row : rows[row];
+			}
+			
+			// Only a sample of the items is measured
+			int EstimateWidth(const QFontMetrics& metrics) const {
+				int width = 0;
+				for (int i = 0 ; i < qMin(count, 100) ; ++i) {
+					width = qMax(width, metrics.horizontalAdvance(text_source(i)));
+				}
+				
+				return width + (icon_source ? 16 + 8 : 8);
+			}
+			
+			int rowCount(const QModelIndex& parent) const override {
+				if (parent.isValid()) return 0;
+				return filter.isEmpty() ? count : rows.count();
+			}
+			
+			QVariant data(const QModelIndex& index, int role) const override {
+				if (!index.isValid()) return QVariant();
+				
+				switch (role) {
+					case Qt::DisplayRole:
+						return text_source(SourceRow(index.row()));
+					
+					case Qt::DecorationRole:
+						if (icon_source) return IconCache::Icon(icon_source(SourceRow(index.row())), QSize(16, 16));
+						return QVariant();
+					
+					default:
+						return QVariant();
+				}
+			}
+		
+		private:
+			int count;
+			std::function<QString(int)> text_source;
+			std::function<QIcon(int)> icon_source;
+			
+			QString filter;
+			QVector<int> rows;  // Source rows matching the filter
+			
+			// All lower case texts separated by line feeds, requested on the first filter
+			QString buffer;
+			QVector<int> offsets;
+			
+			void BuildBuffer() {
+				offsets.reserve(count);
+				for (int i = 0 ; i < count ; ++i) {
+					offsets << buffer.length();
+					buffer += text_source(i).toLower();
+					buffer += '\n';
+				}
+			}
+			
+			QStringView Text(int row) const {
+				const int end = (row + 1 < count) ? offsets[row + 1] : buffer.length();
+				return QStringView(buffer).mid(offsets[row], end - offsets[row] - 1);
+			}
+	};
+	
+	// List of the item dialog, typing changes the filter instead of jumping to an item
+	class ItemListView : public QListView {
+		public:
+			ItemListView(QWidget* parent, QLineEdit* filter):
+					QListView(parent), filter(filter) {}
+			
+			void keyboardSearch(const QString&) override {}
+		
+		protected:
+			void keyPressEvent(QKeyEvent* event) override {
+				const bool is_text = !event->text().isEmpty() && event->text()[0].isPrint();
+				if (is_text || (event->key() == Qt::Key_Backspace) || (event->key() == Qt::Key_Delete)) {
+					if (!filter->isVisible()) filter->setCursorPosition(filter->text().length());
+					QApplication::sendEvent(filter, event);
+					return;
+				}
+				
+				QListView::keyPressEvent(event);
+				
+				// QuickDialog accepts the dialog when return is pressed
+				if ((event->key() == Qt::Key_Return) || (event->key() == Qt::Key_Enter)) event->ignore();
+			}
+		
+		private:
+			QLineEdit* const filter;
+	};
+	
 	QuickDialog::QuickDialog(QWidget* parent, const QString& title):
 			QDialog(parent), ui(new Ui::QuickDialog()), content_widget(nullptr) {
 		ui->setupUi(this);
@@ -26,65 +192,154 @@ namespace nova {
 	}
 	
 	QuickDialog::~QuickDialog() noexcept {
-		// Popups can issue some display errors, so the parent should be repainted.
-		dynamic_cast<QWidget*>(parent())->repaint();
-		
 		delete ui;
 	}
 	
 	QString QuickDialog::InputText(QWidget* parent, const QString& title, const QString& placeholder,
 	                               QLineEdit::EchoMode mode, const QString& default_text, bool under_cursor) {
-		QuickDialog dialog(parent, title);
+		QuickDialog* dialog = FindCachedDialog(parent, NOVA_TEXT_DIALOG);
+		std::unique_ptr<QuickDialog> temporary_dialog;
+		if (dialog == nullptr) {
+			// The cached dialog is already running (e.g. nested calls)
+			temporary_dialog.reset(ConstructTextDialog(parent));
+			dialog = temporary_dialog.get();
+		}
 		
-		QLineEdit line_edit(&dialog);
-		line_edit.setMinimumWidth(350);
-		line_edit.setPlaceholderText(placeholder);
-		line_edit.setEchoMode(mode);
-		line_edit.setText(default_text);
-		line_edit.selectAll();
-		dialog.set_content_widget(&line_edit);
+		auto* line_edit = static_cast<QLineEdit*>(dialog->get_content_widget());
+		line_edit->setPlaceholderText(placeholder);
+		line_edit->setEchoMode(mode);
+		line_edit->setText(default_text);
+		line_edit->selectAll();
+		line_edit->setFocus();
 		
-		if (under_cursor) dialog.PositionAt(QCursor::pos());
+		dialog->set_title(title);
+		if (under_cursor) dialog->PositionAt(QCursor::pos());
+		else dialog->setAttribute(Qt::WA_Moved, false);  // Center the dialog like a new one
 		
-		if (dialog.exec() == QDialog::Accepted) return line_edit.text();
-        else return QString();
+		const QString text = (dialog->exec() == QDialog::Accepted) ? line_edit->text() : QString();
+		
+		// The cached dialog mustn't keep the text (e.g. a password), setText() also clears the undo history
+		line_edit->setText(QString());
+		line_edit->setEchoMode(QLineEdit::Normal);
+		return text;
 	}
 	
 	int QuickDialog::InputItemIndex(QWidget* parent, const QString& title, const QStringList& items,
 	                                const QList<QIcon>& icons, int current_index, bool under_cursor) {
-		QuickDialog dialog(parent, title);
+		const auto icon_source = [&icons](int index) { return (index < icons.count()) ? icons[index] : QIcon(); };
 		
-		QListWidget list_widget(&dialog);
-		for (const QString& i : items) {
-			list_widget.addItem(i);
+		return InputItemIndex(parent, title, items.count(), [&items](int index) { return items[index]; },
+		                      icons.isEmpty() ? nullptr : std::function<QIcon(int)>(icon_source), current_index, under_cursor);
+	}
+	
+	int QuickDialog::InputItemIndex(QWidget* parent, const QString& title, int count,
+	                                const std::function<QString(int)>& text_source,
+	                                const std::function<QIcon(int)>& icon_source, int current_index, bool under_cursor) {
+		QuickDialog* dialog = FindCachedDialog(parent, NOVA_ITEM_DIALOG);
+		std::unique_ptr<QuickDialog> temporary_dialog;
+		if (dialog == nullptr) {
+			// The cached dialog is already running (e.g. nested calls)
+			temporary_dialog.reset(ConstructItemDialog(parent));
+			dialog = temporary_dialog.get();
 		}
-		for (int i = 0 ; i < icons.length() ; ++i) {
-			QListWidgetItem* item = list_widget.item(i);
-			if (item != nullptr) item->setIcon(icons[i]);
+		
+		auto* filter = dialog->get_content_widget()->findChild<QLineEdit*>();
+		auto* list_view = dialog->get_content_widget()->findChild<QListView*>();
+		auto* model = static_cast<ItemListModel*>(list_view->model());
+		
+		filter->clear();
+		model->Reset(count, text_source, icon_source);
+		
+		// Make the dialog as small as possible, but never higher than a few rows
+		const int row_height = qMax(list_view->sizeHintForRow(0), list_view->fontMetrics().height());
+		const int visible_rows = qBound(1, count, NOVA_MAX_VISIBLE_ITEMS);
+		list_view->setFixedSize(qBound(150, model->EstimateWidth(list_view->fontMetrics()), 600) + 2 * list_view->frameWidth(),
+		                        row_height * visible_rows + 2 * list_view->frameWidth());
+		list_view->setCurrentIndex(model->index(qBound(0, current_index, qMax(0, count - 1))));
+		list_view->scrollTo(list_view->currentIndex(), QAbstractItemView::PositionAtCenter);
+		list_view->setFocus();
+		
+		dialog->set_title(title);
+		if (under_cursor) dialog->PositionAt(QCursor::pos());
+		else dialog->setAttribute(Qt::WA_Moved, false);  // Center the dialog like a new one
+		
+		int result = -1;
+		if ((dialog->exec() == QDialog::Accepted) && list_view->currentIndex().isValid()) {
+			result = model->SourceRow(list_view->currentIndex().row());
 		}
 		
-		dialog.set_content_widget(&list_widget);
-		// Make the dialog as small as possible
-		list_widget.setMinimumWidth(150);
-		list_widget.setIconSize(QSize(16, 16));
-		list_widget.setMaximumSize(list_widget.sizeHintForColumn(0) + 2 * list_widget.frameWidth(),
-		                           list_widget.sizeHintForRow(0) * list_widget.count() + 2 * list_widget.frameWidth());
-		list_widget.setMinimumHeight(list_widget.maximumHeight());
-		list_widget.setCurrentRow(current_index);
+		model->Reset(0, nullptr, nullptr);  // The sources might reference temporary objects
+		return result;
+	}
+	
+	void QuickDialog::Prewarm(QWidget* parent) {
+		for (QuickDialog* i : {FindCachedDialog(parent, NOVA_TEXT_DIALOG), FindCachedDialog(parent, NOVA_ITEM_DIALOG)}) {
+			if (i == nullptr) continue;
+			
+			// Computes the style and the layout now instead of on the first show
+			i->ensurePolished();
+			i->layout()->activate();
+		}
+	}
+	
+	QuickDialog* QuickDialog::ConstructTextDialog(QWidget* parent) {
+		auto* dialog = new QuickDialog(parent, QString());
+		
+		auto* line_edit = new QLineEdit(dialog);
+		line_edit->setMinimumWidth(350);
+		dialog->set_content_widget(line_edit);
 		
-		if (under_cursor) dialog.PositionAt(QCursor::pos());
+		return dialog;
+	}
+	
+	QuickDialog* QuickDialog::ConstructItemDialog(QWidget* parent) {
+		auto* dialog = new QuickDialog(parent, QString());
+		
+		auto* widget = new QWidget(dialog);
+		auto* layout = new QVBoxLayout(widget);
+		layout->setContentsMargins(0, 0, 0, 0);
+		layout->setSpacing(0);
+		
+		auto* filter = new QLineEdit(widget);
+		auto* list_view = new ItemListView(widget, filter);
+		filter->setFocusPolicy(Qt::NoFocus);  // Typing in the list changes the filter
+		filter->hide();
 		
-		QObject::connect(&list_widget, &QListWidget::itemClicked, &dialog, &QuickDialog::accept);
+		list_view->setModel(new ItemListModel(list_view));
+		list_view->setUniformItemSizes(true);  // Rows are never measured one by one
+		list_view->setIconSize(QSize(16, 16));
+		list_view->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+		
+		layout->addWidget(filter);
+		layout->addWidget(list_view);
+		dialog->set_content_widget(widget);
+		
+		QObject::connect(filter, &QLineEdit::textChanged, list_view, [filter, list_view](const QString& text) {
+			static_cast<ItemListModel*>(list_view->model())->SetFilter(text);
+			filter->setVisible(!text.isEmpty());
+			list_view->setCurrentIndex(list_view->model()->index(0, 0));
+		});
+		QObject::connect(list_view, &QListView::clicked, dialog, &QuickDialog::accept);
 		
 		// Select by hovering
-		list_widget.setMouseTracking(true);
-		QObject::connect(&list_widget, &QListWidget::itemEntered,
-		                 [&list_widget](QListWidgetItem* item) {
-			                 list_widget.setCurrentItem(item);
-		                 });
-		
-		if (dialog.exec() == QDialog::Accepted) return list_widget.currentRow();
-		else return -1;
+		list_view->setMouseTracking(true);
+		QObject::connect(list_view, &QListView::entered, list_view, [list_view](const QModelIndex& index) {
+			list_view->setCurrentIndex(index);
+		});
+		
+		return dialog;
+	}
+	
+	QuickDialog* QuickDialog::FindCachedDialog(QWidget* parent, const QString& name) {
+		if (parent == nullptr) return nullptr;
+		
+		auto* dialog = parent->findChild<QuickDialog*>(name, Qt::FindDirectChildrenOnly);
+		if (dialog == nullptr) {
+			dialog = (name == NOVA_TEXT_DIALOG) ? ConstructTextDialog(parent) : ConstructItemDialog(parent);
+			dialog->setObjectName(name);
+		}
+		
+		return dialog->isVisible() ? nullptr : dialog;
 	}
 	
 	void QuickDialog::PositionAt(const QPoint& point) {
@@ -143,4 +398,11 @@ namespace nova {
 		QDialog::keyPressEvent(event);
 		if (event->key() == Qt::Key_Return) accept();
 	}
+	
+	void QuickDialog::hideEvent(QHideEvent* event) {
+		QDialog::hideEvent(event);
+		
+		// Popups can issue some display errors, so the parent should be repainted in the next frame
+		if (parentWidget() != nullptr) parentWidget()->update();
+	}
 }
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#include "registrationqueue.h"
+
+#include <QtGlobal>
+#include <QMetaObject>
+#include <QHash>
+#include <QAction>
+#include <QIcon>
+
+#include "workbench.h"
+#include "actionprovider.h"
+#include "trace.h"
+
+namespace {
+	// The plugin being initialized on this thread, its descriptions are committed when it's activated
+	thread_local const void* staging_owner = nullptr;
+}
+
+namespace nova {
+	RegistrationQueue::RegistrationQueue(Workbench* window):
+			window(window), staged(nullptr) {}
+	
+	RegistrationQueue::~RegistrationQueue() noexcept {
+		Entry* entry = staged.exchange(nullptr);
+		while (entry != nullptr) {
+			Entry* next = entry->next;
+			delete entry;
+			entry = next;
+		}
+		
+		qDeleteAll(held);
+		qDeleteAll(providers);
+	}
+	
+	void RegistrationQueue::StageProvider(const QString& title) {
+		Stage(new Entry{Entry::Provider, title, 0, ActionDescription(), staging_owner, nullptr});
+	}
+	
+	int RegistrationQueue::StageGroup(const QString& provider, int id) {
+		if (id == 0) id = ActionGroup::GenerateId();
+		
+		Stage(new Entry{Entry::Group, provider, id, ActionDescription(), staging_owner, nullptr});
+		return id;
+	}
+	
+	void RegistrationQueue::StageAction(const QString& provider, int group, const ActionDescription& action) {
+		Stage(new Entry{Entry::Action, provider, group, action, staging_owner, nullptr});
+	}
+	
+	void RegistrationQueue::Stage(Entry* entry) {
+		// Lock-free push, only the GUI thread takes entries (all at once), so there's no ABA problem
+		Entry* head = staged.load(std::memory_order_relaxed);
+		do {
+			entry->next = head;
+		} while (!staged.compare_exchange_weak(head, entry, std::memory_order_release, std::memory_order_relaxed));
+		
+		// The first entry of a batch schedules the commit
+		if (head == nullptr) {
+			QMetaObject::invokeMethod(window, [this]() { Commit(); }, Qt::QueuedConnection);
+		}
+	}
+	
+	int RegistrationQueue::Commit() {
+		return Commit(nullptr);
+	}
+	
+	int RegistrationQueue::Commit(const void* owner) {
+		const QList<Entry*> entries = TakeEntries(owner);
+		if (entries.isEmpty()) return 0;
+		
+		NOVA_TRACE_SCOPE("RegistrationQueue::Commit");
+		
+		// Each provider is looked up once per batch instead of once per entry
+		QHash<QString, ActionProvider*> resolved;
+		
+		for (Entry* entry : entries) {
+			auto resolved_provider = resolved.find(entry->provider);
+			if (resolved_provider == resolved.end()) {
+				resolved_provider = resolved.insert(entry->provider, window->FindActionProvider(entry->provider));
+			}
+			ActionProvider*& provider = resolved_provider.value();  // Constructed providers are cached, too
+			
+			switch (entry->type) {
+				case Entry::Provider:
+					if (provider == nullptr) provider = ConstructProvider(entry->provider);
+					break;
+				
+				case Entry::Group:
+					if (provider == nullptr) provider = ConstructProvider(entry->provider);
+					if (provider->FindGroup(entry->group) == nullptr) provider->ShowActionGroup(new ActionGroup(entry->group));
+					break;
+				
+				case Entry::Action: {
+					if (provider == nullptr) provider = ConstructProvider(entry->provider);
+					
+					const ActionDescription& description = entry->action;
+					QAction* action = provider->ConstructAction(description.text);
+					action->setObjectName(description.id);
+					action->setToolTip(description.tool_tip);
+					action->setShortcut(description.shortcut);
+					
+					// QIcon must be constructed on the GUI thread
+					if (description.icon.startsWith("theme:")) action->setIcon(QIcon::fromTheme(description.icon.mid(6)));
+					else if (!description.icon.isEmpty()) action->setIcon(QIcon(description.icon));
+					
+					if (description.triggered) QObject::connect(action, &QAction::triggered, description.triggered);
+					
+					ActionGroup* group = (entry->group == 0) ? nullptr : provider->FindGroup(entry->group);
+					if (group == nullptr) {
+						group = new ActionGroup(entry->group == 0 ? ActionGroup::GenerateId() : entry->group);
+						provider->ShowActionGroup(group);
+					}
+					group->AddAction(action, description.is_important_action);
+					break;
+				}
+			}
+			
+			delete entry;
+		}
+		
+		return entries.count();
+	}
+	
+	void RegistrationQueue::Discard(const void* owner) {
+		qDeleteAll(TakeEntries(owner));
+	}
+	
+	QList<RegistrationQueue::Entry*> RegistrationQueue::TakeEntries(const void* owner) {
+		// Restore the staging order, the held entries have been staged before
+		QList<Entry*> entries;
+		for (Entry* i = staged.exchange(nullptr, std::memory_order_acquire) ; i != nullptr ; i = i->next) {
+			entries.prepend(i);
+		}
+		entries = held + entries;
+		held.clear();
+		
+		// The entries of other owners are kept until they are taken
+		QList<Entry*> taken;
+		for (Entry* i : entries) {
+			if (i->owner == owner) taken << i;
+			else held << i;
+		}
+		
+		return taken;
+	}
+	
+	void RegistrationQueue::SetStagingOwner(const void* owner) {
+		staging_owner = owner;
+	}
+	
+	bool RegistrationQueue::DeleteProvider(ActionProvider* provider) {
+		if (!providers.removeOne(provider)) return false;
+		
+		delete provider;
+		return true;
+	}
+	
+	ActionProvider* RegistrationQueue::ConstructProvider(const QString& title) {
+		auto* provider = new ActionProvider(title);
+		providers << provider;
+		window->RegisterActionProvider(provider);
+		return provider;
+	}
+}
@@ -5,13 +5,22 @@
 
 #include "searchbar.h"
 
+#include <algorithm>
+
 #include <Qt>
 #include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMutexLocker>
+#include <QMetaObject>
+#include <QSize>
 #include <QRegExp>
 #include <QIcon>
 #include <QBrush>
 #include <QKeySequence>
 #include <QKeyEvent>
+#include <QShowEvent>
+#include <QHideEvent>
 #include <QApplication>
 #include <QWidget>
 #include <QVBoxLayout>
@@ -23,12 +32,22 @@
 
 #include "workbench.h"
 #include "actionprovider.h"
+#include "usagestore.h"
+#include "iconcache.h"
+#include "translations.h"
+#include "trace.h"
 
 #define NOVA_CONTEXT "nova/searchbar"
+#define NOVA_PROPOSED_ACTIONS 10  // Shown before anything is typed
+#define NOVA_SEARCH_RESULTS 100  // The best results being displayed
+#define NOVA_CONTRIBUTED_ICONS 256  // Icons of contributed results being kept
+#define NOVA_USAGE_WEIGHT 0.5  // How much frequent uses raise the score of a match at most
 
 namespace nova {
 	SearchBar::SearchBar(Workbench* window) :
 			QuickDialog(window, NOVA_TR("Search...")) {
+		NOVA_TRACE_SCOPE("SearchBar::SearchBar");
+		
 		auto* widget = new QWidget(this);
 		auto* layout = new QVBoxLayout(widget);
 		layout->setContentsMargins(0, 0, 0, 0);
@@ -46,6 +65,7 @@ namespace nova {
 		results->header()->hide();
 		results->headerItem()->setText(1, QString());  // Second column
 		results->setRootIsDecorated(false);
+		results->setIconSize(QSize(16, 16));  // The size of the cached icons
 		
 		results->hide();
 		
@@ -64,6 +84,10 @@ namespace nova {
 		        });
 	}
 	
+	SearchBar::~SearchBar() noexcept {
+		CancelSearch();
+	}
+	
 	void SearchBar::keyPressEvent(QKeyEvent* event) {
 		// The dialog shouldn't be immediately closed when return is pressed -> skip QuickDialog::keyPressEvent()
 		QDialog::keyPressEvent(event);  // NOLINT
@@ -91,56 +115,235 @@ namespace nova {
 		}
 	}
 	
+	void SearchBar::showEvent(QShowEvent* event) {
+		// Reused dialogs start with an empty query
+		if (!search_bar->text().isEmpty()) search_bar->clear();
+		
+		// Results must reflect the current settings
+		auto* window = dynamic_cast<Workbench*>(parent());
+		window->FlushSettingsActions();
+		window->AssociateUsedActions(NOVA_PROPOSED_ACTIONS);
+		
+		ShowProposals();
+		
+		search_bar->setFocus();
+		setAttribute(Qt::WA_Moved, false);  // Center the dialog like a new one
+		
+		QuickDialog::showEvent(event);
+	}
+	
+	void SearchBar::hideEvent(QHideEvent* event) {
+		CancelSearch();
+		QuickDialog::hideEvent(event);
+	}
+	
 	void SearchBar::suggest() {
-		if (!search_bar->text().isEmpty()) {
-			results->show();
-			results->clear();
-			
-			action_results.clear();
+		CancelSearch();
+		
+		if (search_bar->text().isEmpty()) {
+			ShowProposals();
+			return;
+		}
+		
+		results->show();
+		results->clear();
+		
+		entries.clear();
+		
+		const auto* window = dynamic_cast<const Workbench*>(parent());
+		const QString text = search_bar->text();
+		
+		// Contributors search in the background, their results are merged when they arrive
+		if (!window->search_contributors.isEmpty()) {
+			session = std::make_shared<SearchQuery::Session>();
 			
-			const QRegExp reg_exp(search_bar->text(), Qt::CaseInsensitive, QRegExp::WildcardUnix);
+			const std::weak_ptr<SearchQuery::Session> current = session;
+			session->notify = [this, current]() {
+				QMetaObject::invokeMethod(this, [this, current]() {
+					if (current.lock() == session) MergeResults();
+				}, Qt::QueuedConnection);
+			};
 			
-			for (const ActionProvider* i: dynamic_cast<const Workbench*>(parent())->providers) {
-				for (QAction* j: i->ListActions()) {
-					if (!j->isVisible() || (reg_exp.indexIn(j->toolTip()) == -1)) continue;
-					action_results << j;
-					
-					auto* item = new QTreeWidgetItem(results);
-					
-					item->setText(0, j->toolTip() +  // Adding the shortcut if available
-					                 (j->shortcut().isEmpty() ? "" : " (" + j->shortcut().toString() + ")"));
-					item->setText(1, i->get_title());
-					item->setToolTip(0, j->whatsThis());
-					// Don't allow the user to check items (see trigger()) (no Qt::ItemIsUserCheckable)
-					item->setFlags(j->isEnabled() ? Qt::ItemIsEnabled | Qt::ItemIsSelectable : Qt::NoItemFlags);
-					
-					item->setTextAlignment(1, Qt::AlignTrailing | Qt::AlignVCenter);  // Right aligned
-					QFont font;
-					font.setItalic(true);
-					item->setFont(1, font);
-					
-					if (!j->icon().isNull()) item->setIcon(0, j->icon());
-					if (j->isCheckable()) item->setCheckState(0, j->isChecked() ? Qt::Checked : Qt::Unchecked);
-				}
+			for (SearchContributor* i : window->search_contributors) {
+				i->Start(SearchQuery(text, i->get_title(), i->get_time_budget(), session));
 			}
+		}
+		
+		const QRegExp reg_exp(text, Qt::CaseInsensitive, QRegExp::WildcardUnix);
+		const QHash<QAction*, double> scores = window->usage_store->ListScores();
+		
+		QList<Entry> matches;
+		for (ActionProvider* i: window->providers) {
+			i->UpdateActions();  // Only if the context has been invalidated
 			
-			// If nothing is found
-			if (action_results.isEmpty()) {
-				auto* item = new QTreeWidgetItem(results);
-				item->setText(0, NOVA_TR("Nothing found"));
-				item->setFlags(Qt::ItemIsEnabled);
-				item->setForeground(0, QBrush(Qt::gray));
+			for (QAction* j: i->ListActions()) {
+				if (!j->isVisible()) continue;
+				
+				const double score = SearchQuery::Rate(reg_exp, j->toolTip());
+				if (score == 0) continue;
+				
+				Entry entry{j, SearchResult()};
+				entry.result.category = i->get_title();
+				
+				// Uses raise the score by up to half, so that much better matches still come first
+				const auto iterator = scores.constFind(j);
+				const double usage = (iterator == scores.constEnd()) ? 0 : iterator.value() / (1 + iterator.value());
+				entry.result.score = score * (1 + NOVA_USAGE_WEIGHT * usage);
+				
+				matches << entry;
 			}
+		}
+		
+		std::stable_sort(matches.begin(), matches.end(), [](const Entry& first, const Entry& second) {
+			return first.result.score > second.result.score;
+		});
+		
+		for (int i = 0 ; i < qMin(matches.count(), NOVA_SEARCH_RESULTS) ; ++i) {
+			InsertEntry(i, matches[i]);
+		}
+		
+		// If nothing is found (yet)
+		if (entries.isEmpty()) {
+			auto* item = new QTreeWidgetItem(results);
+			item->setText(0, NOVA_TR_CACHED(SearchBar_NothingFound));
+			item->setFlags(Qt::ItemIsEnabled);
+			item->setForeground(0, QBrush(Qt::gray));
+		}
+		
+		results->resizeColumnToContents(0);
+		results->setCurrentItem(results->topLevelItem(0));
+	}
+	
+	void SearchBar::ShowProposals() {
+		results->clear();
+		entries.clear();
+		
+		const auto* window = dynamic_cast<const Workbench*>(parent());
+		
+		QStringList providers;
+		const QList<QAction*> actions = window->usage_store->ListRanked(NOVA_PROPOSED_ACTIONS, &providers);
+		for (int i = 0 ; i < actions.count() ; ++i) {
+			// Proposals might have been unregistered or their state might be outdated
+			ActionProvider* provider = window->FindActionProvider(providers[i]);
+			if (provider == nullptr) continue;
+			
+			provider->UpdateActions();
+			if (!actions[i]->isVisible()) continue;
 			
-			results->resizeColumnToContents(0);
-			results->setCurrentItem(results->topLevelItem(0));
-		} else results->hide();
+			Entry entry{actions[i], SearchResult()};
+			entry.result.category = provider->get_title();
+			InsertEntry(entries.count(), entry);
+		}
+		
+		if (entries.isEmpty()) {
+			results->hide();
+			return;
+		}
+		
+		results->show();
+		results->resizeColumnToContents(0);
+		results->setCurrentItem(results->topLevelItem(0));
+	}
+	
+	void SearchBar::InsertEntry(int index, const Entry& entry) {
+		entries.insert(index, entry);
+		
+		auto* item = new QTreeWidgetItem();
+		item->setText(1, entry.result.category);
+		item->setTextAlignment(1, Qt::AlignTrailing | Qt::AlignVCenter);  // Right aligned
+		QFont font;
+		font.setItalic(true);
+		item->setFont(1, font);
+		
+		QAction* action = entry.action;
+		if (action != nullptr) {
+			item->setText(0, action->toolTip() +  // Adding the shortcut if available
+			                 (action->shortcut().isEmpty() ? "" : " (" + action->shortcut().toString() + ")"));
+			item->setToolTip(0, action->whatsThis());
+			// Don't allow the user to check items (see trigger()) (no Qt::ItemIsUserCheckable)
+			item->setFlags(action->isEnabled() ? Qt::ItemIsEnabled | Qt::ItemIsSelectable : Qt::NoItemFlags);
+			
+			if (!action->icon().isNull()) item->setIcon(0, IconCache::Icon(action->icon(), QSize(16, 16)));
+			if (action->isCheckable()) item->setCheckState(0, action->isChecked() ? Qt::Checked : Qt::Unchecked);
+		} else {
+			item->setText(0, entry.result.text);
+			item->setToolTip(0, entry.result.tool_tip);
+			item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+			
+			if (!entry.result.icon.isEmpty()) item->setIcon(0, ContributedIcon(entry.result.icon));
+		}
+		
+		results->insertTopLevelItem(index, item);
+	}
+	
+	QIcon SearchBar::ContributedIcon(const QString& path) {
+		// A new QIcon per result would be decoded again and add an entry with a new cache key to nova::IconCache
+		const auto iterator = contributed_icons.constFind(path);
+		if (iterator != contributed_icons.constEnd()) return iterator.value();
+		
+		if (contributed_icons.count() >= NOVA_CONTRIBUTED_ICONS) contributed_icons.clear();
+		
+		const QIcon icon = path.startsWith("theme:") ? QIcon::fromTheme(path.mid(6)) : QIcon(path);
+		return *contributed_icons.insert(path, IconCache::Icon(icon, QSize(16, 16)));
+	}
+	
+	void SearchBar::MergeResults() {
+		NOVA_TRACE_SCOPE("SearchBar::MergeResults");
+		
+		QList<SearchResult> merged;
+		{
+			const QMutexLocker locker(&session->mutex);
+			merged.swap(session->pending_results);
+		}
+		
+		if (entries.isEmpty()) results->clear();  // Removes "Nothing found"
+		
+		for (const SearchResult& i : merged) {
+			// Results with the same score keep the order of their arrival
+			const auto position = std::upper_bound(entries.begin(), entries.end(), i.score, [](double score, const Entry& entry) {
+				return score > entry.result.score;
+			});
+			
+			const int index = static_cast<int>(position - entries.begin());
+			if (index >= NOVA_SEARCH_RESULTS) continue;
+			
+			InsertEntry(index, Entry{nullptr, i});
+			
+			// Top K
+			if (entries.count() > NOVA_SEARCH_RESULTS) {
+				entries.removeLast();
+				delete results->takeTopLevelItem(NOVA_SEARCH_RESULTS);
+			}
+		}
+		
+		results->resizeColumnToContents(0);
+		if (results->currentItem() == nullptr) results->setCurrentItem(results->topLevelItem(0));
+	}
+	
+	void SearchBar::CancelSearch() {
+		if (session == nullptr) return;
+		
+		session->is_cancelled = true;
+		{
+			// Running contributors can't post further merges
+			const QMutexLocker locker(&session->mutex);
+			session->notify = nullptr;
+		}
+		
+		session.reset();
 	}
 	
 	void SearchBar::trigger(QTreeWidgetItem* item) {
-		if (action_results.isEmpty()) return;
+		if (entries.isEmpty()) return;
 		
-		QAction* action = action_results[results->indexOfTopLevelItem(item)];
+		const Entry entry = entries[results->indexOfTopLevelItem(item)];
+		if (entry.action == nullptr) {
+			accept();
+			if (entry.result.activate) entry.result.activate();
+			return;
+		}
+		
+		QAction* action = entry.action;
 		if (!action->isEnabled()) return;
 		
 		if (!action->isCheckable()) {
@@ -149,6 +352,9 @@ namespace nova {
 		} else {
 			action->setChecked(!action->isChecked());
 			item->setCheckState(0, action->isChecked() ? Qt::Checked : Qt::Unchecked);
+			
+			// Toggling doesn't emit QAction::triggered()
+			dynamic_cast<Workbench*>(parent())->usage_store->RecordUse(item->text(1), action);
 		}
 	}
 }
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#include "searchcontributor.h"
+
+#include <utility>
+
+#include <QChar>
+#include <QMutexLocker>
+#include <QLoggingCategory>
+#include <QDebug>
+
+#include "trace.h"
+
+Q_LOGGING_CATEGORY(nova_search, "nova.search", QtWarningMsg)
+
+namespace nova {
+	SearchQuery::SearchQuery(const QString& text, const QString& category, int time_budget, std::shared_ptr<Session> session):
+			text(text), reg_exp(text, Qt::CaseInsensitive, QRegExp::WildcardUnix), category(category),
+			time_budget(time_budget), session(std::move(session)) {}
+	
+	bool SearchQuery::is_cancelled() const {
+		return session->is_cancelled || (clock.isValid() && (clock.elapsed() > time_budget));
+	}
+	
+	qint64 SearchQuery::get_remaining_time() const {
+		return clock.isValid() ? qMax<qint64>(0, time_budget - clock.elapsed()) : time_budget;
+	}
+	
+	void SearchQuery::Report(const SearchResult& result) {
+		if (is_cancelled()) return;
+		
+		SearchResult copy = result;
+		if (copy.category.isEmpty()) copy.category = category;
+		
+		const QMutexLocker locker(&session->mutex);
+		if (!session->notify) return;  // Cancelled in the meantime
+		
+		// Results reported before the merge is run are merged together
+		session->pending_results << copy;
+		if (session->pending_results.count() == 1) session->notify();
+	}
+	
+	double SearchQuery::Rate(const QRegExp& reg_exp, const QString& text) {
+		const int index = reg_exp.indexIn(text);
+		if (index == -1) return 0;
+		
+		if ((index == 0) && (reg_exp.matchedLength() == text.length())) return 1;
+		if (index == 0) return 0.75;
+		if (!text[index - 1].isLetterOrDigit()) return 0.5;
+		return 0.25;
+	}
+	
+	SearchContributor::SearchContributor(const QString& title, int time_budget):
+			title(title), time_budget(time_budget) {
+		worker.setMaxThreadCount(1);
+	}
+	
+	void SearchContributor::Start(const SearchQuery& query) {
+		worker.start([this, query]() mutable {
+			// Superseded while other searches of this contributor were running
+			if (query.session->is_cancelled) return;
+			
+			NOVA_TRACE_SCOPE("SearchContributor::Search");
+			
+			query.clock.start();
+			Search(query);
+			
+			if (query.clock.elapsed() > query.time_budget) {
+				qCDebug(nova_search).nospace() << "\"" << title << "\" exceeded its time budget of " << query.time_budget
+				                               << " ms (" << query.clock.elapsed() << " ms)";
+			}
+		});
+	}
+	
+	void SearchContributor::Wait() {
+		worker.waitForDone();
+	}
+}
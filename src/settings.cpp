@@ -5,13 +5,26 @@
 
 #include "settings.h"
 
+#include <algorithm>
+
 #include <Qt>
 #include <QtGlobal>
 #include <QVariant>
 #include <QMetaType>
+#include <QMetaObject>
+#include <QMetaProperty>
 #include <QRegExp>
+#include <QChar>
 #include <QList>
+#include <QVector>
+#include <QHash>
 #include <QStringList>
+#include <QPalette>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QDebug>
+#include <QEvent>
+#include <QDynamicPropertyChangeEvent>
 #include <QHideEvent>
 #include <QAction>
 #include <QSplitter>
@@ -23,16 +36,35 @@
 #include <QStackedWidget>
 #include <QGroupBox>
 #include <QListWidgetItem>
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+#include <QHeaderView>
+#include <QBrush>
+#include <QFont>
 #include <QCheckBox>
+#include <QScrollBar>
+#include <QAbstractItemView>
+#include <QTabBar>
 #include <QLineEdit>
 #include <QCompleter>
 #include <QMessageBox>
 
 #include "ui_settingsdialog.h"
 #include "workbench.h"
+#include "settingsstore.h"
+#include "trace.h"
+#include "translations.h"
 
 #define NOVA_CONTEXT "nova/settings"
 #define NOVA_SETTING_PROPERTY_NAME "nova/setting"
+#define NOVA_MAX_FILTER_RESULTS 100  // Creating more items would slow down typing
+
+Q_LOGGING_CATEGORY(nova_settings, "nova.settings", QtWarningMsg)
+
+// Helper which converts the elapsed time of a timer to milliseconds (for logging)
+static inline double ElapsedMilliseconds(const QElapsedTimer& timer) {
+	return (static_cast<double>(timer.nsecsElapsed()) / 1000000.0);
+}
 
 // Helper which evaluates the setting's name by considering the property "nova/setting"
 static QString EvaluateSettingsName(const QWidget* widget) {
@@ -51,9 +83,191 @@ static QString EvaluateSettingsName(const QWidget* widget) {
 	}
 }
 
+// Helper which splits a text into lower case words (used by the settings index)
+static QStringList Tokenize(const QString& text) {
+	QStringList tokens;
+	QString current;
+	
+	for (const QChar& i : text) {
+		if (i.isLetterOrNumber()) {
+			current += i.toLower();
+		} else if (!current.isEmpty()) {
+			tokens << current;
+			current.clear();
+		}
+	}
+	
+	if (!current.isEmpty()) tokens << current;
+	return tokens;
+}
+
+// Helper which highlights a settings widget matching the filter
+static void SetHighlighted(QWidget* widget, bool is_highlighted) {
+	// The original appearance is stored in the widget, so that it can be restored
+	const bool is_saved = widget->property("nova/highlight_background_role").isValid();
+	
+	if (is_highlighted) {
+		if (!is_saved) {
+			widget->setProperty("nova/highlight_auto_fill", widget->autoFillBackground());
+			widget->setProperty("nova/highlight_background_role", static_cast<int>(widget->backgroundRole()));
+			widget->setProperty("nova/highlight_foreground_role", static_cast<int>(widget->foregroundRole()));
+		}
+		
+		widget->setAutoFillBackground(true);
+		widget->setBackgroundRole(QPalette::Highlight);
+		widget->setForegroundRole(QPalette::HighlightedText);
+	} else if (is_saved) {
+		widget->setAutoFillBackground(widget->property("nova/highlight_auto_fill").toBool());
+		widget->setBackgroundRole(static_cast<QPalette::ColorRole>(widget->property("nova/highlight_background_role").toInt()));
+		widget->setForegroundRole(static_cast<QPalette::ColorRole>(widget->property("nova/highlight_foreground_role").toInt()));
+		
+		widget->setProperty("nova/highlight_auto_fill", QVariant());
+		widget->setProperty("nova/highlight_background_role", QVariant());
+		widget->setProperty("nova/highlight_foreground_role", QVariant());
+	}
+}
+
 namespace nova {
+	// Inverted index (word -> settings) over all settings of a dialog
+	class SettingsIndex {
+		public:
+			struct Setting {
+				int page;
+				QWidget* widget;
+				QString name;
+				QStringList words;
+			};
+			
+			explicit SettingsIndex(const QList<SettingsPage*>& pages);
+			NOVA_DISABLE_COPY(SettingsIndex)
+			
+			// Returns the indexes of all matching settings (in ascending order)
+			QVector<int> Find(const QString& query);
+			
+			inline const Setting& get_setting(int index) const { return settings[index]; }
+			inline int get_setting_count() const { return settings.count(); }
+		
+		private:
+			QVector<Setting> settings;
+			QVector<QString> tokens;  // Sorted to allow prefix search
+			QVector<QVector<int>> postings;  // The settings containing the token at the same position
+			
+			// The last query, used to narrow the results while the user is typing
+			QString last_query;
+			QVector<int> last_result;
+			
+			QVector<int> hits;  // Scratch buffer to intersect the postings
+			
+			static bool MatchesWords(const Setting& setting, const QStringList& query_words);
+	};
+	
+	SettingsIndex::SettingsIndex(const QList<SettingsPage*>& pages) {
+		NOVA_TRACE_SCOPE("SettingsIndex::SettingsIndex");
+		
+		QHash<QString, QVector<int>> token_map;
+		
+		for (int i = 0 ; i < pages.count() ; ++i) {
+			// Keep the order of the actions, which is the order of the widgets in the page
+			QHash<const QAction*, QWidget*> widgets;
+			for (auto j = pages[i]->setting_actions.constBegin() ; j != pages[i]->setting_actions.constEnd() ; ++j) {
+				widgets.insert(j.value(), j.key());
+			}
+			
+			for (const QAction* j : pages[i]->ListActions()) {
+				const int index = settings.count();
+				const QStringList words = Tokenize(j->toolTip());
+				settings << Setting({i, widgets.value(j, nullptr), j->toolTip(), words});
+				
+				for (const QString& k : words) {
+					QVector<int>& posting = token_map[k];
+					if (posting.isEmpty() || (posting.last() != index)) posting << index;
+				}
+			}
+		}
+		
+		tokens.reserve(token_map.count());
+		for (auto i = token_map.constBegin() ; i != token_map.constEnd() ; ++i) {
+			tokens << i.key();
+		}
+		
+		std::sort(tokens.begin(), tokens.end());
+		
+		postings.reserve(tokens.count());
+		for (const QString& i : tokens) {
+			postings << token_map.value(i);
+		}
+		
+		hits.resize(settings.count());
+	}
+	
+	QVector<int> SettingsIndex::Find(const QString& query) {
+		QVector<int> result;
+		const QStringList query_words = Tokenize(query);
+		
+		if (query.contains('*') || query.contains('?') || query.contains('[') || query_words.isEmpty()) {
+			// Wildcards and queries without words cannot use the index
+			const QRegExp reg_exp(query, Qt::CaseInsensitive, QRegExp::WildcardUnix);
+			for (int i = 0 ; i < settings.count() ; ++i) {
+				if (reg_exp.indexIn(settings[i].name) != -1) result << i;
+			}
+			
+			last_query.clear();
+			return result;
+		}
+		
+		if (!last_query.isEmpty() && query.startsWith(last_query)) {
+			// The query has only been extended, so the results can only become less
+			for (int i : last_result) {
+				if (MatchesWords(settings[i], query_words)) result << i;
+			}
+		} else {
+			// Every word of the query must be the prefix of a word of the setting
+			hits.fill(0);
+			for (int i = 0 ; i < query_words.count() ; ++i) {
+				const QString& word = query_words[i];
+				
+				for (auto j = std::lower_bound(tokens.constBegin(), tokens.constEnd(), word) ;
+				     (j != tokens.constEnd()) && j->startsWith(word) ; ++j) {
+					for (int k : postings[static_cast<int>(j - tokens.constBegin())]) {
+						if (hits[k] == i) hits[k] = i + 1;
+					}
+				}
+			}
+			
+			for (int i = 0 ; i < hits.count() ; ++i) {
+				if (hits[i] == query_words.count()) result << i;
+			}
+		}
+		
+		last_query = query;
+		last_result = result;
+		return result;
+	}
+	
+	bool SettingsIndex::MatchesWords(const Setting& setting, const QStringList& query_words) {
+		for (const QString& i : query_words) {
+			bool is_matching = false;
+			for (const QString& j : setting.words) {
+				if (j.startsWith(i)) {
+					is_matching = true;
+					break;
+				}
+			}
+			
+			if (!is_matching) return false;
+		}
+		
+		return true;
+	}
+	
 	SettingsDialog::SettingsDialog(Workbench* window):
-			QDialog(window), ui(new Ui::SettingsDialog()), window(window), pages(window->settings_pages) {
+			QDialog(window), ui(new Ui::SettingsDialog()), window(window), pages(window->settings_pages), settings_index(nullptr) {
+		NOVA_TRACE_SCOPE("SettingsDialog::SettingsDialog");
+		
+		// The index is built from the settings actions, which might still wait for the idle queue
+		window->FlushSettingsActions();
+		settings_index = new SettingsIndex(pages);
+		
 		ui->setupUi(this);
 		
 		ui->lneFilter->setPlaceholderText(NOVA_TR("Filter"));
@@ -79,19 +293,21 @@ namespace nova {
 			ui->lswNavigation->addItem(i->get_title());
 			ui->stwTitles->addWidget(title_widget);
 			ui->stwPages->addWidget(i->content_widget);
-			
-			i->LoadSettings();
 		}
 		
+		// Pages the user never opens don't have to be loaded
+		connect(ui->lswNavigation, &QListWidget::currentRowChanged, this, [this](int row) {
+			if ((row >= 0) && (row < pages.count())) LoadSettingsPage(pages[row]);
+		});
+		
 		ui->splNavigationPages->setSizes({300, 700});
 		ui->lswNavigation->setCurrentRow(0);
+		if (!pages.isEmpty()) LoadSettingsPage(pages[0]);  // The row might already be selected
 		
 		// Completer
 		QStringList list;
-		for (const SettingsPage* i : pages) {
-			for (const QAction* j : i->ListActions()) {
-				list << j->text();
-			}
+		for (int i = 0 ; i < settings_index->get_setting_count() ; ++i) {
+			list << settings_index->get_setting(i).name;
 		}
 		
 		auto* completer = new QCompleter(list, this);
@@ -100,7 +316,15 @@ namespace nova {
 		completer->setMaxVisibleItems(5);
 		ui->lneFilter->setCompleter(completer);
 		
+		ui->trwResults->setColumnCount(2);
+		ui->trwResults->header()->hide();
+		ui->trwResults->header()->setStretchLastSection(false);
+		ui->trwResults->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+		ui->trwResults->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+		
 		connect(ui->lneFilter, &QLineEdit::textChanged, this, &SettingsDialog::lneFilterTextChanged);
+		connect(ui->trwResults, &QTreeWidget::itemClicked, this, &SettingsDialog::trwResultsItemActivated);
+		connect(ui->trwResults, &QTreeWidget::itemActivated, this, &SettingsDialog::trwResultsItemActivated);
 		
 		connect(ui->btbButtonBox->button(QDialogButtonBox::RestoreDefaults), &QPushButton::clicked,
 		        this, &SettingsDialog::restoreDefaults);
@@ -108,6 +332,11 @@ namespace nova {
 		        this, &SettingsDialog::apply);
 	}
 	
+	SettingsDialog::~SettingsDialog() noexcept {
+		delete settings_index;
+		delete ui;
+	}
+	
 	void SettingsDialog::OpenSettingsPage(SettingsPage* page) {
 		const int index = pages.indexOf(page);
 		if (index != -1) ui->lswNavigation->setCurrentRow(index);
@@ -123,50 +352,108 @@ namespace nova {
 		}
 		
 		// Because the virtual Ui will be soon created, the settings must be applied now (and not by signals and slot which are too late)
-		if (result() == QDialog::Accepted) apply();
+		if (result() == QDialog::Accepted) {
+			apply();
+		} else {
+			// Discard the changes, so that the actions reflect the real configuration
+			for (SettingsPage* i : loaded_pages) {
+				if (i->is_modified()) {
+					i->LoadSettings();
+					i->MarkUnmodified();
+				}
+			}
+		}
+		
+		// The widgets outlive the dialog
+		for (QWidget* i : highlighted_widgets) {
+			SetHighlighted(i, false);
+		}
+		
+		highlighted_widgets.clear();
 		
-		Properties parameters;
-		parameters["workbench"] = reinterpret_cast<quintptr>(window);
 		for (SettingsPage* i : pages) {
 			// Remove the parent
 			i->content_widget->setParent(nullptr);
-			i->RecreateActions(parameters);
 		}
 		
+		// Pages which were never opened haven't changed, the others are updated when the event loop is idle
+		window->ScheduleSettingsActions(loaded_pages.values());
+		
 		event->accept();
 	}
 	
 	void SettingsDialog::lneFilterTextChanged(const QString& query) {
 		if (ui->lswNavigation->count() == 0) return;
 		
-		const QRegExp reg_exp(query, Qt::CaseInsensitive, QRegExp::WildcardUnix);
+		QVector<int> matches;
+		if (!query.isEmpty()) matches = settings_index->Find(query);
 		
-		// Undo previous filters
-		for (int i = 0 ; i < ui->lswNavigation->count() ; ++i) {
-			ui->lswNavigation->item(i)->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);  // Normal item
+		QVector<int> page_matches(pages.count(), 0);
+		QSet<QWidget*> matching_widgets;
+		for (int i : matches) {
+			const SettingsIndex::Setting& setting = settings_index->get_setting(i);
+			++page_matches[setting.page];
+			
+			// Highlighting group boxes would highlight all of their children
+			if ((setting.widget != nullptr) && (dynamic_cast<QGroupBox*>(setting.widget) == nullptr)) {
+				matching_widgets.insert(setting.widget);
+			}
+		}
+		
+		// Only change the items and widgets whose state differs from the previous query
+		for (int i = 0 ; i < pages.count() ; ++i) {
+			QListWidgetItem* item = ui->lswNavigation->item(i);
+			const bool is_enabled = (query.isEmpty() || (page_matches[i] > 0));
+			
+			if (item->flags().testFlag(Qt::ItemIsEnabled) != is_enabled) {
+				// Normal or disabled item
+				item->setFlags(is_enabled ? (Qt::ItemIsEnabled | Qt::ItemIsSelectable) : Qt::NoItemFlags);
+			}
 		}
 		
+		for (QWidget* i : highlighted_widgets) {
+			if (!matching_widgets.contains(i)) SetHighlighted(i, false);
+		}
+		
+		for (QWidget* i : matching_widgets) {
+			if (!highlighted_widgets.contains(i)) SetHighlighted(i, true);
+		}
+		
+		highlighted_widgets = matching_widgets;
+		
+		// List the matching settings of all pages
+		ui->trwResults->clear();
+		
+		const int result_count = qMin(matches.count(), NOVA_MAX_FILTER_RESULTS);
+		for (int i = 0 ; i < result_count ; ++i) {
+			const SettingsIndex::Setting& setting = settings_index->get_setting(matches[i]);
+			
+			auto* item = new QTreeWidgetItem(ui->trwResults);
+			item->setText(0, setting.name);
+			item->setText(1, pages[setting.page]->get_title());
+			item->setData(0, Qt::UserRole, matches[i]);
+			
+			item->setTextAlignment(1, Qt::AlignTrailing | Qt::AlignVCenter);  // Right aligned
+			QFont font;
+			font.setItalic(true);
+			item->setFont(1, font);
+		}
+		
+		// If nothing is found
+		if (!query.isEmpty() && matches.isEmpty()) {
+			auto* item = new QTreeWidgetItem(ui->trwResults);
+			item->setText(0, NOVA_TR_CACHED(SettingsDialog_NothingFound));
+			item->setFlags(Qt::ItemIsEnabled);
+			item->setForeground(0, QBrush(Qt::gray));
+		}
+		
+		ui->trwResults->setVisible(!query.isEmpty());
+		
 		if (query.isEmpty()) {
 			ui->lswNavigation->setCurrentRow(0);
 			ui->lblMatches->setVisible(false);
 		} else {
-			int matches_sum = 0;
-			
-			for (int i = 0 ; i < pages.count() ; ++i) {
-				const SettingsPage* page = pages[i];
-				int matches = 0;
-				
-				for (const QAction* j : page->ListActions()) {
-					if (reg_exp.indexIn(j->toolTip()) != -1) ++matches;
-				}
-				
-				matches_sum += matches;
-				
-				// No matches in this page
-				if (matches == 0) ui->lswNavigation->item(i)->setFlags(Qt::NoItemFlags);  // Disabled
-			}
-			
-			ui->lblMatches->setText(NOVA_TR("Filtered: %1 match(es)").arg(matches_sum));
+			ui->lblMatches->setText(NOVA_TR_CACHED(SettingsDialog_Filtered).arg(matches.count()));
 			ui->lblMatches->setVisible(true);
 			
 			// Scroll to first item being enabled
@@ -182,12 +469,52 @@ namespace nova {
 		}
 	}
 	
+	void SettingsDialog::trwResultsItemActivated(QTreeWidgetItem* item) {
+		const QVariant& data = item->data(0, Qt::UserRole);
+		if (!data.isValid()) return;  // "Nothing found"
+		
+		const SettingsIndex::Setting& setting = settings_index->get_setting(data.toInt());
+		ui->lswNavigation->setCurrentRow(setting.page);
+		if (setting.widget != nullptr) setting.widget->setFocus();
+	}
+	
 	void SettingsDialog::apply() {
 		for (SettingsPage* i : pages) {
+			// Pages which haven't been loaded can't be edited
+			if (!loaded_pages.contains(i) || !i->is_modified()) continue;
+			
+			QElapsedTimer timer;
+			timer.start();
+			
 			i->Apply();
+			i->MarkUnmodified();
+			const bool is_valid = i->ValidateConfiguration();
+			
+			qCDebug(nova_settings).nospace() << "Applied \"" << i->get_title() << "\" in " << ElapsedMilliseconds(timer) << " ms";
+			
+			if (!is_valid) {
+				window->ShowNotification(NOVA_TR("Settings"),
+				                         NOVA_TR("The settings of \"%1\" are incomplete or corrupted.").arg(i->get_title()),
+				                         Notification::Warning);
+			}
 		}
 	}
 	
+	void SettingsDialog::LoadSettingsPage(SettingsPage* page) {
+		if (loaded_pages.contains(page)) return;
+		
+		NOVA_TRACE_SCOPE("SettingsDialog::LoadSettingsPage");
+		
+		QElapsedTimer timer;
+		timer.start();
+		
+		page->LoadSettings();
+		page->MarkUnmodified();  // Loading changes the widgets too
+		loaded_pages.insert(page);
+		
+		qCDebug(nova_settings).nospace() << "Loaded \"" << page->get_title() << "\" in " << ElapsedMilliseconds(timer) << " ms";
+	}
+	
 	void SettingsDialog::restoreDefaults() {
 		QMessageBox msg_box(this);
 		
@@ -201,13 +528,16 @@ namespace nova {
 			for (SettingsPage* i : pages) {
 				i->RestoreDefaults();
 				i->LoadSettings();
+				i->MarkUnmodified();
+				loaded_pages.insert(i);
 			}
 		}
 	}
 	
 	SettingsPage::SettingsPage(QObject* parent, const QString& title):
 			QObject(parent), TempActionProvider(NOVA_TR("Settings > ") + title),
-			title(title), content_widget(new QWidget()) {}
+			title(title), content_widget(new QWidget()), settings_store(nullptr), window(nullptr), needs_rebuild(true), is_updating(false),
+			modified(false), is_comparable(true), navigation_action(nullptr) {}
 	
 	SettingsPage::~SettingsPage() noexcept {
 		delete content_widget;
@@ -216,37 +546,162 @@ namespace nova {
 	void SettingsPage::RecreateActions(const Properties& creation_parameters) {
 		if (!creation_parameters.contains("workbench")) return;
 		
+		NOVA_TRACE_SCOPE("SettingsPage::RecreateActions");
+		
 		auto* window = reinterpret_cast<Workbench*>(creation_parameters["workbench"].toULongLong());
+		if (needs_rebuild || (window != this->window)) {
+			this->window = window;
+			RebuildActions();
+			return;
+		}
+		
+		// Nothing has changed since the last call
+		if (outdated_widgets.isEmpty()) return;
+		
+		is_updating = true;
+		for (QWidget* i : outdated_widgets) {
+			QAction* action = setting_actions.value(i, nullptr);
+			if (action != nullptr) UpdateSettingAction(i, action);
+		}
+		
+		outdated_widgets.clear();
+		is_updating = false;
+	}
+	
+	bool SettingsPage::eventFilter(QObject* watched, QEvent* event) {
+		switch (event->type()) {
+			case QEvent::EnabledChange:
+			case QEvent::LanguageChange:
+				MarkOutdated(static_cast<QWidget*>(watched));
+				break;
+			
+			case QEvent::DynamicPropertyChange:
+				if (static_cast<QDynamicPropertyChangeEvent*>(event)->propertyName() == NOVA_SETTING_PROPERTY_NAME) {
+					MarkOutdated(static_cast<QWidget*>(watched));
+				}
+				break;
+			
+			default:
+				break;
+		}
+		
+		return QObject::eventFilter(watched, event);
+	}
+	
+	void SettingsPage::RebuildActions() {
 		ClearActions();
 		
+		// Drop the tracking of the old settings widgets
+		for (QWidget* i : setting_actions.keys()) {
+			i->removeEventFilter(this);
+		}
+		
+		for (const QMetaObject::Connection& i : tracking_connections) {
+			disconnect(i);
+		}
+		
+		tracking_connections.clear();
+		setting_actions.clear();
+		outdated_widgets.clear();
+		
+		is_updating = true;
 		const QList<QWidget*>& settings_widgets = content_widget->findChildren<QWidget*>();
 		for (QWidget* i : settings_widgets) {
 			// Match group boxes automatically
-			auto* group_box = dynamic_cast<QGroupBox*>(i);
-			if (group_box != nullptr) group_box->setProperty(NOVA_SETTING_PROPERTY_NAME, group_box->title());
+			if ((dynamic_cast<QGroupBox*>(i) == nullptr) && !i->property(NOVA_SETTING_PROPERTY_NAME).isValid()) continue;
+			
+			QAction* action = ConstructAction(QString());
+			UpdateSettingAction(i, action);
+			setting_actions.insert(i, action);
 			
-			if (i->property(NOVA_SETTING_PROPERTY_NAME).isValid()) {
-				QAction* action = ConstructAction(EvaluateSettingsName(i));
-				action->setWhatsThis(i->whatsThis());
+			auto* check_box = dynamic_cast<QCheckBox*>(i);
+			if (check_box != nullptr) {
+				// Bool setting
+				action->setCheckable(true);
 				
-				auto* check_box = dynamic_cast<QCheckBox*>(i);
-				if (check_box != nullptr) {
-					// Bool setting
-					action->setEnabled(i->isEnabled());
-					action->setCheckable(true);
-					action->setChecked(check_box->isChecked());
-					
-					connect(action, &QAction::toggled, [check_box, this](bool toggled) {
-						check_box->setChecked(toggled);
-						Apply();
-					});
-				} else {
-					connect(action, &QAction::triggered, [this, window, i]() {
-						window->OpenSettings(this, i);
-					});
-				}
+				connect(action, &QAction::toggled, [check_box, this](bool toggled) {
+					check_box->setChecked(toggled);
+					Apply();
+				});
+				tracking_connections << connect(check_box, &QCheckBox::toggled, this, [this, i]() { MarkOutdated(i); });
+			} else {
+				connect(action, &QAction::triggered, [this, i]() {
+					window->OpenSettings(this, i);
+				});
 			}
+			
+			i->installEventFilter(this);
+			tracking_connections << connect(i, &QObject::destroyed, this, [this, i]() {
+				delete setting_actions.take(i);
+				outdated_widgets.remove(i);
+			});
 		}
+		
+		needs_rebuild = false;
+		is_updating = false;
+	}
+	
+	bool SettingsPage::is_modified() const {
+		if (modified || !is_comparable) return true;
+		
+		for (const auto& i : loaded_values) {
+			// Deleted or replaced widgets might have contained changes
+			if (i.first.isNull()) return true;
+			if (i.first->metaObject()->userProperty().read(i.first) != i.second) return true;
+		}
+		
+		return false;
+	}
+	
+	void SettingsPage::MarkUnmodified() {
+		modified = false;
+		is_comparable = true;
+		loaded_values.clear();
+		SaveLoadedValues(content_widget);
+	}
+	
+	void SettingsPage::SaveLoadedValues(QWidget* parent) {
+		for (QWidget* i : parent->findChildren<QWidget*>(QString(), Qt::FindDirectChildrenOnly)) {
+			// Scroll and tab bars only change the view
+			if ((dynamic_cast<QScrollBar*>(i) != nullptr) || (dynamic_cast<QTabBar*>(i) != nullptr)) continue;
+			
+			// The user property is the value of the settings widget (e.g. QLineEdit::text or QCheckBox::checked)
+			const QMetaProperty property = i->metaObject()->userProperty();
+			if (property.isReadable()) {
+				// The children belong to the value (e.g. the line edit of a spin box)
+				loaded_values << qMakePair(QPointer<QWidget>(i), property.read(i));
+			} else if (dynamic_cast<QAbstractItemView*>(i) != nullptr) {
+				is_comparable = false;  // Tables, lists and trees
+			} else if (i->findChild<QWidget*>(QString(), Qt::FindDirectChildrenOnly) == nullptr) {
+				if (i->focusPolicy() != Qt::NoFocus) is_comparable = false;  // Custom editors
+			} else {
+				SaveLoadedValues(i);  // Containers (e.g. group boxes or tab widgets)
+			}
+		}
+	}
+	
+	void SettingsPage::UpdateSettingAction(QWidget* widget, QAction* action) {
+		auto* group_box = dynamic_cast<QGroupBox*>(widget);
+		if ((group_box != nullptr) && (group_box->property(NOVA_SETTING_PROPERTY_NAME).toString() != group_box->title())) {
+			group_box->setProperty(NOVA_SETTING_PROPERTY_NAME, group_box->title());
+		}
+		
+		action->setText(EvaluateSettingsName(widget));
+		action->setWhatsThis(widget->whatsThis());
+		
+		auto* check_box = dynamic_cast<QCheckBox*>(widget);
+		if (check_box != nullptr) {
+			// Don't emit toggled() because the settings haven't changed
+			const bool old_state = action->blockSignals(true);
+			action->setEnabled(widget->isEnabled());
+			action->setChecked(check_box->isChecked());
+			action->blockSignals(old_state);
+		}
+	}
+	
+	void SettingsPage::MarkOutdated(QWidget* widget) {
+		// Changes made by UpdateSettingAction() itself are already up-to-date
+		if (!is_updating) outdated_widgets.insert(widget);
 	}
 	
 	void SettingsPage::set_content_widget(QWidget* content_widget) {
@@ -255,10 +710,49 @@ namespace nova {
 		
 		this->content_widget = content_widget;
 		this->content_widget->setParent(nullptr); // It's important to prevent having a parent because of destruction processes
+		needs_rebuild = true;
+	}
+	
+	void SettingsPage::BindSetting(QWidget* widget, const QString& key, const QVariant& default_value) {
+		bindings << SettingBinding({widget, key, default_value});
+		
+		// Forget the binding when the widget is deleted
+		connect(widget, &QObject::destroyed, this, [this, widget]() {
+			for (int i = bindings.count() - 1 ; i >= 0 ; --i) {
+				if (bindings[i].widget == widget) bindings.removeAt(i);
+			}
+		});
+	}
+	
+	void SettingsPage::RestoreDefaults() {
+		if (settings_store == nullptr) return;
+		
+		for (const SettingBinding& i : bindings) {
+			settings_store->SetValue(i.key, i.default_value);
+		}
+	}
+	
+	void SettingsPage::LoadSettings() {
+		if (settings_store == nullptr) return;
+		
+		for (const SettingBinding& i : bindings) {
+			const QMetaProperty property = i.widget->metaObject()->userProperty();
+			if (property.isValid()) property.write(i.widget, settings_store->Value(i.key, i.default_value));
+		}
+	}
+	
+	void SettingsPage::Apply() {
+		if (settings_store == nullptr) return;
+		
+		for (const SettingBinding& i : bindings) {
+			const QMetaProperty property = i.widget->metaObject()->userProperty();
+			if (property.isValid()) settings_store->SetValue(i.key, property.read(i.widget));
+		}
 	}
 	
 	void SettingsPage::ConstructNavigationAction(ActionProvider* provider, Workbench* window) {
-		connect(provider->ConstructAction(title), &QAction::triggered, [this, window]() {
+		navigation_action = provider->ConstructAction(title);
+		connect(navigation_action, &QAction::triggered, [this, window]() {
 			window->OpenSettings(this);
 		});
 	}
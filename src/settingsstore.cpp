@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#include "settingsstore.h"
+#include "trace.h"
+
+#include <QThread>
+#include <QCoreApplication>
+#include <QStringList>
+#include <QMetaObject>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace nova {
+	SettingsStore::SettingsStore(const QString& file_name, QSettings::Format format, QObject* parent):
+			QObject(parent), file_name(file_name), format(format) {
+		NOVA_TRACE_SCOPE("SettingsStore::SettingsStore");
+		
+		// The file is only read once, all further reads are served from memory
+		const QSettings settings(file_name, format);
+		for (const QString& i : settings.allKeys()) {
+			values.insert(i, settings.value(i));
+		}
+		
+		writer.setMaxThreadCount(1);
+		
+		write_timer.setSingleShot(true);
+		write_timer.setInterval(500);
+		connect(&write_timer, &QTimer::timeout, this, &SettingsStore::writePendingChanges);
+		
+		// Applications often don't destroy the store before they exit
+		if (QCoreApplication::instance() != nullptr) {
+			connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &SettingsStore::Sync);
+		}
+	}
+	
+	SettingsStore::~SettingsStore() noexcept {
+		Sync();
+	}
+	
+	QVariant SettingsStore::Value(const QString& key, const QVariant& default_value) const {
+		const QReadLocker locker(&lock);
+		return values.value(key, default_value);
+	}
+	
+	void SettingsStore::SetValue(const QString& key, const QVariant& value) {
+		{
+			const QWriteLocker locker(&lock);
+			
+			if (value.isValid()) {
+				const auto iterator = values.constFind(key);
+				if ((iterator != values.constEnd()) && (iterator.value() == value)) return;
+				
+				values.insert(key, value);  // Snapshots being in use are detached (copy-on-write)
+			} else if (values.remove(key) == 0) {
+				return;
+			}
+			
+			pending_changes.insert(key, value);
+		}
+		
+		// The timer belongs to the store's thread
+		if (QThread::currentThread() == thread()) write_timer.start();
+		else QMetaObject::invokeMethod(&write_timer, "start", Qt::QueuedConnection);
+		
+		emit valueChanged(key, value);
+	}
+	
+	bool SettingsStore::Contains(const QString& key) const {
+		const QReadLocker locker(&lock);
+		return values.contains(key);
+	}
+	
+	SettingsSnapshot SettingsStore::Snapshot() const {
+		const QReadLocker locker(&lock);
+		return values;
+	}
+	
+	void SettingsStore::Sync() {
+		write_timer.stop();
+		writePendingChanges();
+		writer.waitForDone();
+	}
+	
+	void SettingsStore::writePendingChanges() {
+		QHash<QString, QVariant> changes;
+		{
+			const QWriteLocker locker(&lock);
+			changes.swap(pending_changes);
+		}
+		
+		if (changes.isEmpty()) return;
+		
+		writer.start([file_name = file_name, format = format, changes]() {
+			QSettings settings(file_name, format);
+			for (auto i = changes.constBegin() ; i != changes.constEnd() ; ++i) {
+				if (i.value().isValid()) settings.setValue(i.key(), i.value());
+				else settings.remove(i.key());
+			}
+			
+			settings.sync();
+		});
+	}
+}
@@ -0,0 +1,408 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#include "shortcutdispatcher.h"
+
+#include <QtGlobal>
+#include <QList>
+#include <QEvent>
+#include <QChildEvent>
+#include <QKeyEvent>
+#include <QLoggingCategory>
+#include <QDebug>
+#include <QCoreApplication>
+#include <QApplication>
+#include <QWidget>
+#include <QDockWidget>
+#include <QMenu>
+#include <QAction>
+
+#include "actionprovider.h"
+#include "trace.h"
+
+Q_LOGGING_CATEGORY(nova_shortcuts, "nova.shortcuts", QtWarningMsg)
+
+namespace {
+	// Floating tool windows belong to the workbench
+	QWidget* OwningWindow(QWidget* widget) {
+		QWidget* window = widget->window();
+		auto* dock = qobject_cast<QDockWidget*>(window);
+		if ((dock != nullptr) && (dock->parentWidget() != nullptr)) window = dock->parentWidget()->window();
+		return window;
+	}
+	
+	// Like Qt's shortcut map, an action needs a visible widget of the window, menus are followed to their menu bar
+	bool IsShownIn(const QAction* action, QWidget* window, int depth = 0) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+		const QList<QObject*> associated = action->associatedObjects();
+#else
+		const QList<QWidget*> associated = action->associatedWidgets();
+#endif
+		
+		for (QObject* i : associated) {
+			auto* widget = qobject_cast<QWidget*>(i);
+			if (widget == nullptr) continue;
+			
+			auto* menu = qobject_cast<QMenu*>(widget);
+			if (menu != nullptr) {
+				if ((depth < 8) && IsShownIn(menu->menuAction(), window, depth + 1)) return true;  // Limits cyclic submenus
+			} else if (widget->isVisible() && (OwningWindow(widget) == window)) {
+				return true;
+			}
+		}
+		
+		return false;
+	}
+}
+
+namespace nova {
+	ShortcutDispatcher::ShortcutDispatcher(QWidget* window):
+			QObject(window), window(window), current(&root), pending_action(nullptr), is_key_pending(false),
+			is_delivering(false), double_tap_interval(500), last_tap_key(0) {
+		// Key events are filtered before Qt's shortcut map is used, child events to track the providers' actions
+		qApp->installEventFilter(this);
+		
+		// A sequence which is the prefix of a longer one is complete if no further key is pressed
+		sequence_timer.setSingleShot(true);
+		sequence_timer.setInterval(1000);
+		connect(&sequence_timer, &QTimer::timeout, this, [this]() {
+			QAction* action = SelectAction(current);
+			current = &root;
+			if (action != nullptr) action->trigger();
+		});
+	}
+	
+	ShortcutDispatcher::~ShortcutDispatcher() noexcept {
+		if (qApp != nullptr) qApp->removeEventFilter(this);
+	}
+	
+	void ShortcutDispatcher::AddProvider(ActionProvider* provider) {
+		QObject* object = &provider->object;
+		if (providers.contains(object)) return;
+		
+		providers.insert(object, provider);
+		
+		for (QAction* i : provider->ListActions()) {
+			Watch(i);
+		}
+	}
+	
+	void ShortcutDispatcher::RemoveProvider(ActionProvider* provider) {
+		QObject* object = &provider->object;
+		if (providers.remove(object) == 0) return;
+		
+		for (QAction* i : provider->ListActions()) {
+			Forget(i);
+		}
+	}
+	
+	void ShortcutDispatcher::SetDoubleTapAction(Qt::Key key, QAction* action) {
+		if (action == nullptr) {
+			double_taps.remove(key);
+			return;
+		}
+		
+		double_taps.insert(key, action);
+		connect(action, &QObject::destroyed, this, [this, key, action]() {
+			if (double_taps.value(key, nullptr) == action) double_taps.remove(key);
+		});
+	}
+	
+	QAction* ShortcutDispatcher::FindAction(const QKeySequence& sequence) {
+		ApplyChanges();
+		
+		const Node* node = &root;
+		for (int i = 0 ; (i < sequence.count()) && (node != nullptr) ; ++i) {
+			node = node->children.value(SequenceKey(sequence, i), nullptr);
+		}
+		
+		if ((node == nullptr) || node->actions.isEmpty()) return nullptr;
+		return static_cast<QAction*>(node->actions.first());
+	}
+	
+	QList<QList<QAction*>> ShortcutDispatcher::FindConflicts() {
+		ApplyChanges();
+		
+		QList<QList<QAction*>> conflicts;
+		QList<const Node*> nodes = {&root};
+		while (!nodes.isEmpty()) {
+			const Node* node = nodes.takeLast();
+			for (const Node* i : node->children) {
+				nodes << i;
+			}
+			
+			if (node->actions.count() > 1) {
+				QList<QAction*> conflict;
+				for (QObject* i : node->actions) {
+					conflict << static_cast<QAction*>(i);
+				}
+				conflicts << conflict;
+			}
+		}
+		
+		return conflicts;
+	}
+	
+	bool ShortcutDispatcher::eventFilter(QObject* watched, QEvent* event) {
+		// Every event of the application passes, so other types return right away
+		switch (event->type()) {
+			case QEvent::ChildAdded:
+			case QEvent::ChildRemoved:
+				// Actions constructed or migrated after the provider has been added
+				if (providers.contains(watched)) {
+					auto* child_event = static_cast<QChildEvent*>(event);
+					if (child_event->added()) Watch(child_event->child());
+					else Forget(child_event->child());
+				}
+				
+				return false;
+			
+			case QEvent::ShortcutOverride:
+			case QEvent::KeyPress:
+				if (is_delivering) return false;  // Sent below
+				break;
+			
+			default:
+				return false;
+		}
+		
+		// Key events are sent to the focus widget first and then propagated to its parents
+		QWidget* receiver = QApplication::focusWidget();
+		if (receiver == nullptr) receiver = QApplication::activeWindow();
+		if ((watched != receiver) || (receiver == nullptr)) return false;
+		
+		if (OwningWindow(receiver) != window) return false;
+		
+		auto* key_event = static_cast<QKeyEvent*>(event);
+		
+		if (event->type() == QEvent::ShortcutOverride) {
+			// Widgets which use the key themselves (e.g. line edits or editors of item delegates) take precedence,
+			// including their event filters
+			is_delivering = true;
+			QCoreApplication::sendEvent(watched, event);
+			is_delivering = false;
+			
+			if (event->isAccepted() || !Resolve(EventKey(key_event))) {
+				// Delivered again as usual
+				event->ignore();
+				return false;
+			}
+			
+			// Handled by the following key press event
+			is_key_pending = true;
+			event->accept();
+			return true;
+		}
+		
+		if (is_key_pending) {
+			is_key_pending = false;
+			last_tap_key = 0;
+			
+			QAction* action = pending_action;
+			pending_action = nullptr;
+			if (action != nullptr) action->trigger();
+			return true;
+		}
+		
+		HandleTap(key_event);
+		return false;
+	}
+	
+	void ShortcutDispatcher::Watch(QObject* object) {
+		if (!entries.contains(object)) {
+			entries.insert(object, Entry());
+			
+			// Children being deleted together with their provider don't cause ChildRemoved events
+			connect(object, &QObject::destroyed, this, [this, object]() { Forget(object); });
+		}
+		
+		// Children are only partially constructed during ChildAdded events, they are inspected later
+		outdated.insert(object);
+	}
+	
+	void ShortcutDispatcher::Forget(QObject* object) {
+		const auto iterator = entries.constFind(object);
+		if (iterator == entries.constEnd()) return;
+		
+		Remove(object, iterator.value().sequences);
+		entries.erase(iterator);
+		outdated.remove(object);
+	}
+	
+	void ShortcutDispatcher::ApplyChanges() {
+		if (outdated.isEmpty()) return;
+		
+		NOVA_TRACE_SCOPE("ShortcutDispatcher::ApplyChanges");
+		
+		QSet<QObject*> changed;
+		changed.swap(outdated);
+		
+		for (QObject* i : changed) {
+			auto* action = qobject_cast<QAction*>(i);
+			auto iterator = entries.find(i);
+			if ((action == nullptr) || (iterator == entries.end())) continue;
+			
+			Entry& entry = iterator.value();
+			if (!entry.is_connected) {
+				entry.is_connected = true;
+				connect(action, &QAction::changed, this, [this, i]() { if (entries.contains(i)) outdated.insert(i); });
+			}
+			
+			// Other contexts are handled by Qt's shortcut map
+			QList<QKeySequence> sequences;
+			const Qt::ShortcutContext context = action->shortcutContext();
+			if ((context == Qt::WindowShortcut) || (context == Qt::ApplicationShortcut)) {
+				for (const QKeySequence& j : action->shortcuts()) {
+					if (!j.isEmpty()) sequences << j;
+				}
+			}
+			
+			// Most changes (e.g. of the enabled state) don't affect the shortcuts
+			if (sequences == entry.sequences) continue;
+			
+			Remove(i, entry.sequences);
+			entry.sequences = sequences;
+			Insert(i, sequences);
+		}
+	}
+	
+	void ShortcutDispatcher::Insert(QObject* action, const QList<QKeySequence>& sequences) {
+		for (const QKeySequence& i : sequences) {
+			Node* node = &root;
+			for (int j = 0 ; j < i.count() ; ++j) {
+				Node*& child = node->children[SequenceKey(i, j)];
+				if (child == nullptr) child = new Node();
+				node = child;
+			}
+			
+			node->actions << action;
+			
+			if (node->actions.count() > 1) {
+				QList<QAction*> conflict;
+				for (QObject* j : node->actions) {
+					conflict << static_cast<QAction*>(j);
+				}
+				
+				qCWarning(nova_shortcuts).nospace() << "The shortcut " << i.toString() << " of \""
+				                                    << static_cast<QAction*>(action)->text() << "\" is already used by \""
+				                                    << conflict.first()->text() << "\"";
+				emit conflictDetected(i, conflict);
+			}
+		}
+	}
+	
+	void ShortcutDispatcher::Remove(QObject* action, const QList<QKeySequence>& sequences) {
+		if (sequences.isEmpty()) return;
+		
+		for (const QKeySequence& i : sequences) {
+			QList<Node*> path = {&root};
+			for (int j = 0 ; (j < i.count()) && (path.last() != nullptr) ; ++j) {
+				path << path.last()->children.value(SequenceKey(i, j), nullptr);
+			}
+			
+			if (path.last() == nullptr) continue;
+			path.last()->actions.removeOne(action);
+			
+			// Remove the nodes which aren't needed anymore
+			for (int j = path.count() - 1 ; j > 0 ; --j) {
+				if (!path[j]->actions.isEmpty() || !path[j]->children.isEmpty()) break;
+				
+				path[j - 1]->children.remove(SequenceKey(i, j - 1));
+				delete path[j];
+			}
+		}
+		
+		// The state might refer to a deleted node
+		current = &root;
+		sequence_timer.stop();
+	}
+	
+	bool ShortcutDispatcher::Resolve(int key) {
+		// Modifiers are pressed before the actual key (e.g. between the keys of "Ctrl+K, Ctrl+C")
+		switch (key & ~Qt::KeyboardModifierMask) {
+			case Qt::Key_Shift:
+			case Qt::Key_Control:
+			case Qt::Key_Alt:
+			case Qt::Key_AltGr:
+			case Qt::Key_Meta:
+				return false;
+			
+			default:
+				break;
+		}
+		
+		ApplyChanges();
+		sequence_timer.stop();
+		
+		Node* node = current->children.value(key, nullptr);
+		if ((node == nullptr) && (current != &root)) {
+			// The key starts a new sequence
+			current = &root;
+			node = root.children.value(key, nullptr);
+		}
+		
+		if (node == nullptr) return false;
+		
+		if (node->children.isEmpty()) {
+			current = &root;
+			pending_action = SelectAction(node);
+			return pending_action != nullptr;  // Keys of disabled actions are passed on
+		}
+		
+		// Wait for the next key of a longer sequence
+		current = node;
+		pending_action = nullptr;
+		sequence_timer.start();
+		return true;
+	}
+	
+	void ShortcutDispatcher::HandleTap(const QKeyEvent* event) {
+		if (event->isAutoRepeat()) return;
+		
+		const int key = event->key();
+		QAction* action = double_taps.value(key, nullptr);
+		if (action == nullptr) {
+			last_tap_key = 0;
+			return;
+		}
+		
+		if ((last_tap_key == key) && (tap_timer.elapsed() <= double_tap_interval)) {
+			// Second tap
+			last_tap_key = 0;
+			if (action->isEnabled()) action->trigger();
+		} else {
+			// First tap
+			last_tap_key = key;
+			tap_timer.start();
+		}
+	}
+	
+	QAction* ShortcutDispatcher::SelectAction(const Node* node) const {
+		for (QObject* i : node->actions) {
+			auto* action = static_cast<QAction*>(i);
+			
+			// The enabled state might depend on an outdated context
+			ActionProvider* provider = providers.value(action->parent(), nullptr);
+			if (provider != nullptr) provider->UpdateActions();
+			
+			// Actions which aren't shown (e.g. only listed by nova::SearchBar) are left to Qt
+			if (action->isEnabled() && IsShownIn(action, window)) return action;
+		}
+		
+		return nullptr;
+	}
+	
+	int ShortcutDispatcher::EventKey(const QKeyEvent* event) {
+		return static_cast<int>(event->modifiers() & ~Qt::KeypadModifier) | event->key();
+	}
+	
+	int ShortcutDispatcher::SequenceKey(const QKeySequence& sequence, int index) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+		return sequence[index].toCombined() & ~Qt::KeypadModifier;
+#else
+		return sequence[index] & ~Qt::KeypadModifier;
+#endif
+	}
+}
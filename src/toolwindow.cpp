@@ -7,19 +7,29 @@
 
 #include <QList>
 #include <QSize>
+#include <QRect>
 #include <QString>
+#include <QShowEvent>
 #include <QLayout>
+#include <QWidget>
 #include <QAction>
 #include <QToolBar>
 #include <QMainWindow>
 
+#include "workbench.h"
+#include "trace.h"
+
+// Appended to the object name of the hidden dock widget, so that QMainWindow::restoreState() finds the shown one
+#define NOVA_INACTIVE_SUFFIX "/inactive"
+
 namespace nova {
 	ToolWindow::ToolWindow(QWidget* parent, const QString& title, Qt::Orientation orientation, bool needs_tool_bar,
 	                       Qt::DockWidgetArea default_layout):
 			QDockWidget(title, parent), ActionProvider(title),
 			nested_main_window(new QMainWindow()),
 			tool_bar(needs_tool_bar ? new QToolBar(nested_main_window) : nullptr), default_layout(default_layout),
-			default_hidden(default_layout == Qt::NoDockWidgetArea), orientation(orientation), initial_size(0) {
+			default_hidden(default_layout == Qt::NoDockWidgetArea), orientation(orientation), initial_size(0),
+			navigation_action(nullptr) {
 		setObjectName("tw" + title);  // For QMainWindow::saveState()
 		setAllowedAreas(orientation == Qt::Vertical ? Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea
 		                                            : Qt::TopDockWidgetArea | Qt::BottomDockWidgetArea);
@@ -37,6 +47,9 @@ namespace nova {
 			                               tool_bar);
 		}
 		
+		// The actions are updated when they appear
+		connect(this, &QDockWidget::visibilityChanged, this, [this](bool visible) { if (visible) UpdateActions(); });
+		
 		// this->default_layout is modified, therefore using this->... for consistency
 		if (default_hidden || !isAreaAllowed(this->default_layout)) {
 			// Illegal default layout or not displayed at beginning
@@ -68,8 +81,21 @@ namespace nova {
 		}
 	}
 	
+	void ToolWindow::HideActions(int index, int count, int, int) {
+		if (tool_bar == nullptr) return;
+		
+		const QList<QAction*> actions = tool_bar->actions();
+		for (int i = qMax(0, index) ; i < qMin(index + count, actions.count()) ; ++i) {
+			tool_bar->removeAction(actions[i]);
+			
+			// Separators are owned by the tool bar
+			if (actions[i]->isSeparator() && (actions[i]->parent() == tool_bar)) delete actions[i];
+		}
+	}
+	
 	void ToolWindow::ConstructNavigationAction(ActionProvider* parent) {
 		QAction* action = parent->ConstructAction(get_title());
+		navigation_action = action;
 		action->setCheckable(true);
 		
 		connect(this, &ToolWindow::visibilityChanged, action, [this, action](bool is_visible) {
@@ -82,4 +108,116 @@ namespace nova {
 		});
 		connect(action, &QAction::toggled, this, &ToolWindow::setVisible);
 	}
+	
+	ToolWindowPlaceholder::ToolWindowPlaceholder(Workbench* window, const QString& title, Qt::Orientation orientation,
+	                                             Qt::DockWidgetArea default_layout,
+	                                             const std::function<ToolWindow*()>& factory, int unload_delay):
+			QDockWidget(title, window), window(window), factory(factory), tool_window(nullptr),
+			default_layout(default_layout), default_hidden(default_layout == Qt::NoDockWidgetArea),
+			orientation(orientation), navigation_action(nullptr) {
+		setObjectName("tw" + title);  // Same as the tool window for QMainWindow::saveState()
+		setAllowedAreas(orientation == Qt::Vertical ? Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea
+		                                            : Qt::TopDockWidgetArea | Qt::BottomDockWidgetArea);
+		setWidget(new QWidget(this));
+		
+		// this->default_layout is modified, therefore using this->... for consistency
+		if (default_hidden || !isAreaAllowed(this->default_layout)) {
+			// Illegal default layout or not displayed at beginning
+			if (default_hidden) hide();
+			this->default_layout = (orientation == Qt::Vertical ? Qt::LeftDockWidgetArea : Qt::BottomDockWidgetArea);
+		}
+		
+		// A negative delay means that the tool window is never destroyed
+		unload_timer.setSingleShot(true);
+		unload_timer.setInterval(unload_delay);
+		connect(&unload_timer, &QTimer::timeout, this, [this]() { DestroyToolWindow(); });
+	}
+	
+	ToolWindow* ToolWindowPlaceholder::CreateToolWindow() {
+		if (tool_window != nullptr) return tool_window;
+		
+		NOVA_TRACE_SCOPE("ToolWindowPlaceholder::CreateToolWindow");
+		
+		tool_window = factory();
+		setObjectName(tool_window->objectName() + NOVA_INACTIVE_SUFFIX);
+		window->RegisterActionProvider(tool_window);
+		window->tool_windows << tool_window;
+		window->TrackLayoutChanges(tool_window);
+		
+		// The tool window takes the placeholder's place
+		const bool is_floating = isFloating();
+		const QRect floating_geometry = geometry();
+		
+		window->addDockWidget(window->dockWidgetArea(this), tool_window);
+		if (is_floating) {
+			tool_window->setFloating(true);
+			tool_window->setGeometry(floating_geometry);
+		} else {
+			window->tabifyDockWidget(this, tool_window);
+		}
+		
+		window->removeDockWidget(this);
+		tool_window->show();
+		tool_window->raise();
+		
+		connect(tool_window, &ToolWindow::visibilityChanged, this, [this](bool is_visible) {
+			UpdateNavigationAction(is_visible);
+			if (is_visible) {
+				if (tool_window->get_content_widget() != nullptr) tool_window->get_content_widget()->setFocus();
+				unload_timer.stop();
+			} else if (unload_timer.interval() >= 0) {
+				unload_timer.start();
+			}
+		});
+		
+		return tool_window;
+	}
+	
+	void ToolWindowPlaceholder::showEvent(QShowEvent* event) {
+		QDockWidget::showEvent(event);
+		
+		// Creating the tool window while the placeholder is being shown would confuse the dock layout
+		if (tool_window == nullptr) QTimer::singleShot(0, this, [this]() { CreateToolWindow(); });
+	}
+	
+	void ToolWindowPlaceholder::ConstructNavigationAction(ActionProvider* provider) {
+		navigation_action = provider->ConstructAction(windowTitle());
+		navigation_action->setCheckable(true);
+		
+		connect(this, &ToolWindowPlaceholder::visibilityChanged, navigation_action, [this](bool is_visible) {
+			// The tool window is responsible once it exists
+			if (tool_window == nullptr) UpdateNavigationAction(is_visible);
+		});
+		connect(navigation_action, &QAction::toggled, this, [this](bool is_checked) {
+			if (is_checked) CreateToolWindow()->show();
+			else if (tool_window != nullptr) tool_window->hide();
+			else hide();
+		});
+	}
+	
+	void ToolWindowPlaceholder::UpdateNavigationAction(bool is_visible) {
+		// Don't emit toggled() to avoid undefined behavior
+		const bool old_state = navigation_action->blockSignals(true);
+		navigation_action->setChecked(is_visible);
+		navigation_action->blockSignals(old_state);
+	}
+	
+	void ToolWindowPlaceholder::DestroyToolWindow() {
+		if ((tool_window == nullptr) || tool_window->isVisible()) return;
+		
+		// The placeholder takes the tool window's place again
+		window->addDockWidget(window->dockWidgetArea(tool_window), this);
+		if (!tool_window->isFloating()) window->tabifyDockWidget(tool_window, this);
+		hide();
+		
+		window->UnregisterActionProvider(tool_window);
+		window->tool_windows.removeAll(tool_window);
+		window->removeDockWidget(tool_window);
+		
+		// The tool window is deleted later, it mustn't be restored meanwhile
+		setObjectName(tool_window->objectName());
+		tool_window->setObjectName(tool_window->objectName() + NOVA_INACTIVE_SUFFIX);
+		tool_window->deleteLater();
+		tool_window = nullptr;
+	}
 }
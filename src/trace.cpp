@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#include "trace.h"
+
+#ifdef NOVA_TRACING
+
+#include <atomic>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QCoreApplication>
+
+#define NOVA_TRACE_CAPACITY 262144  // The latest events being kept (about 8 MB)
+
+namespace {
+	struct TraceEvent {
+		const char* name;
+		qint64 start;
+		qint64 duration;
+		int thread;
+	};
+	
+	void WriteTraceFile() {
+		nova::Trace::WriteChromeTrace(qEnvironmentVariable("NOVA_TRACE_FILE"));
+	}
+	
+	// Construct-on-first-use, because the events of other static objects might be recorded
+	struct TraceBuffer {
+		QElapsedTimer clock;
+		QMutex mutex;
+		std::vector<TraceEvent> events;  // A ring buffer once the capacity is reached
+		std::size_t oldest = 0;  // The index of the oldest event if the buffer is full
+		
+		TraceBuffer() {
+			clock.start();
+			events.reserve(4096);  // Avoids reallocations during the startup
+			
+			if (qEnvironmentVariableIsSet("NOVA_TRACE_FILE")) {
+				// Written when the application quits, since QCoreApplication might never be destroyed
+				qAddPreRoutine([]() {
+					QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, &WriteTraceFile);
+				});
+				
+				// Written again when QCoreApplication is destroyed to include the shutdown
+				qAddPostRoutine(&WriteTraceFile);
+			}
+		}
+	};
+	
+	TraceBuffer& Buffer() {
+		static TraceBuffer buffer;
+		return buffer;
+	}
+	
+	// Small numbers are easier to read in the viewer than native thread ids
+	int ThreadIndex() {
+		static std::atomic<int> thread_counter(0);
+		thread_local const int thread_index = ++thread_counter;
+		return thread_index;
+	}
+	
+	QByteArray EscapeJson(const char* text) {
+		QByteArray result;
+		for (const char* i = text ; *i != '\0' ; ++i) {
+			if ((*i == '"') || (*i == '\\')) result += '\\';
+			result += *i;
+		}
+		
+		return result;
+	}
+	
+	// Ensures that the clock starts when Nova is loaded
+	[[maybe_unused]] const TraceBuffer& initial_buffer = Buffer();
+}
+
+namespace nova {
+	TraceScope::TraceScope(const char* name) noexcept:
+			name(name), start(Trace::Now()) {}
+	
+	TraceScope::~TraceScope() noexcept {
+		Trace::Record(name, start, Trace::Now() - start);
+	}
+	
+	qint64 Trace::Now() noexcept {
+		return Buffer().clock.nsecsElapsed();
+	}
+	
+	void Trace::Record(const char* name, qint64 start, qint64 duration) noexcept {
+		const int thread = ThreadIndex();
+		
+		TraceBuffer& buffer = Buffer();
+		const QMutexLocker locker(&buffer.mutex);
+		if (buffer.events.size() < NOVA_TRACE_CAPACITY) {
+			buffer.events.push_back({name, start, duration, thread});
+		} else {
+			// Overwrites the oldest event
+			buffer.events[buffer.oldest] = {name, start, duration, thread};
+			buffer.oldest = (buffer.oldest + 1) % NOVA_TRACE_CAPACITY;
+		}
+	}
+	
+	bool Trace::WriteChromeTrace(const QString& file_name) {
+		std::vector<TraceEvent> events;
+		{
+			TraceBuffer& buffer = Buffer();
+			const QMutexLocker locker(&buffer.mutex);
+			events.reserve(buffer.events.size());
+			events.insert(events.end(), buffer.events.begin() + buffer.oldest, buffer.events.end());
+			events.insert(events.end(), buffer.events.begin(), buffer.events.begin() + buffer.oldest);
+		}
+		
+		QFile file(file_name);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+		
+		// Complete events ("ph": "X"), time stamps are in microseconds
+		QByteArray json = "{\"traceEvents\":[\n";
+		for (std::size_t i = 0 ; i < events.size() ; i++) {
+			const TraceEvent& event = events[i];
+			
+			json += "{\"name\":\"" + EscapeJson(event.name) + "\",\"cat\":\"nova\",\"ph\":\"X\",\"pid\":"
+			        + QByteArray::number(QCoreApplication::applicationPid())
+			        + ",\"tid\":" + QByteArray::number(event.thread)
+			        + ",\"ts\":" + QByteArray::number(static_cast<double>(event.start) / 1000, 'f', 3)
+			        + ",\"dur\":" + QByteArray::number(static_cast<double>(event.duration) / 1000, 'f', 3) + "}";
+			if (i + 1 < events.size()) json += ',';
+			json += '\n';
+		}
+		json += "],\"displayTimeUnit\":\"ms\"}\n";
+		
+		return file.write(json) == json.size();
+	}
+}
+
+#endif  // NOVA_TRACING
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#include "translations.h"
+
+#include <QThread>
+#include <QApplication>
+
+namespace {
+	struct SourceText {
+		const char* context;
+		const char* text;
+	};
+	
+	// Same order as nova::Translations::Key, QT_TRANSLATE_NOOP() makes the texts visible for lupdate
+	const SourceText source_texts[nova::Translations::Key_Count] = {
+			{"nova/notification", QT_TRANSLATE_NOOP("nova/notification", "Close")},
+			{"nova/searchbar", QT_TRANSLATE_NOOP("nova/searchbar", "Nothing found")},
+			{"nova/settings", QT_TRANSLATE_NOOP("nova/settings", "Nothing found")},
+			{"nova/settings", QT_TRANSLATE_NOOP("nova/settings", "Filtered: %1 match(es)")},
+			{"nova/workbench", QT_TRANSLATE_NOOP("nova/workbench", "Ready")}
+	};
+	
+	QString translations[nova::Translations::Key_Count];
+	bool is_valid = false;
+}
+
+namespace nova {
+	QString Translations::Get(Translations::Key key) {
+		// The table belongs to the GUI thread
+		if (QThread::currentThread() != qApp->thread()) {
+			return QApplication::translate(source_texts[key].context, source_texts[key].text);
+		}
+		
+		if (!is_valid) {
+			for (int i = 0 ; i < Key_Count ; ++i) {
+				translations[i] = QApplication::translate(source_texts[i].context, source_texts[i].text);
+			}
+			
+			is_valid = true;
+		}
+		
+		return translations[key];
+	}
+	
+	void Translations::Invalidate() {
+		is_valid = false;
+	}
+}
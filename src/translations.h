@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#ifndef NOVA_FRAMEWORK_TRANSLATIONS_H
+#define NOVA_FRAMEWORK_TRANSLATIONS_H
+
+#include <QString>
+
+// Internal header: translations of hot paths being resolved once per language instead of on every call
+
+// Returns the cached translation of a nova::Translations::Key, e.g. NOVA_TR_CACHED(Workbench_Ready)
+#define NOVA_TR_CACHED(key) nova::Translations::Get(nova::Translations::key)
+
+namespace nova {
+	class Translations {
+		public:
+			// The texts are listed in translations.cpp, the order must be the same
+			enum Key {
+				Notification_Close,
+				SearchBar_NothingFound,
+				SettingsDialog_NothingFound,
+				SettingsDialog_Filtered,
+				Workbench_Ready,
+				Key_Count
+			};
+			
+			Translations() = delete;
+			
+			// The table is filled on first use and after each invalidation
+			static QString Get(Key key);
+			
+			// Called by nova::Workbench when it receives QEvent::LanguageChange (GUI thread only)
+			static void Invalidate();
+	};
+}
+
+#endif  // NOVA_FRAMEWORK_TRANSLATIONS_H
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#include "usagestore.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QDateTime>
+#include <QDataStream>
+#include <QIODevice>
+#include <QVariant>
+#include <QCoreApplication>
+
+#include "settingsstore.h"
+#include "trace.h"
+
+// Header of the serialized entries
+#define NOVA_USAGE_MAGIC 0x4E555345  // "NUSE"
+#define NOVA_USAGE_FORMAT 1
+
+namespace nova {
+	UsageStore::UsageStore(QObject* parent):
+			QObject(parent), capacity(200), half_life(168), store(nullptr) {
+		// Bursts of uses are saved once
+		save_timer.setSingleShot(true);
+		save_timer.setInterval(1000);
+		connect(&save_timer, &QTimer::timeout, this, [this]() { Save(); });
+	}
+	
+	UsageStore::~UsageStore() noexcept {
+		if (save_timer.isActive()) Save();
+		qDeleteAll(entries);
+	}
+	
+	void UsageStore::RecordUse(const QString& provider, QAction* action) {
+		const QString name = ActionName(action);
+		if (name.isEmpty()) return;
+		
+		const qint64 now = QDateTime::currentMSecsSinceEpoch();
+		const QString id = provider + '/' + name;
+		
+		Entry* entry = entries.value(id, nullptr);
+		if (entry == nullptr) {
+			entry = new Entry{provider, name, 0, now, nullptr};
+			entries.insert(id, entry);
+		}
+		
+		// Decay the previous uses
+		entry->score = DecayedScore(entry, now) + 1;
+		entry->last_use = now;
+		entry->action = action;
+		
+		UpdateRanking();
+		if (store != nullptr) save_timer.start();
+		
+		emit used(action);
+	}
+	
+	void UsageStore::Associate(const QString& provider, QAction* action) {
+		Entry* entry = entries.value(provider + '/' + ActionName(action), nullptr);
+		if (entry != nullptr) entry->action = action;
+	}
+	
+	QHash<QAction*, double> UsageStore::ListScores() const {
+		const qint64 now = QDateTime::currentMSecsSinceEpoch();
+		
+		QHash<QAction*, double> scores;
+		for (const Entry* i : ranking) {
+			if (i->action != nullptr) scores.insert(i->action, DecayedScore(i, now));
+		}
+		
+		return scores;
+	}
+	
+	QList<QAction*> UsageStore::ListRanked(int count, QStringList* providers) const {
+		QList<QAction*> actions;
+		for (const Entry* i : ranking) {
+			if (actions.count() >= count) break;
+			if (i->action == nullptr) continue;
+			
+			actions << i->action;
+			if (providers != nullptr) *providers << i->provider;
+		}
+		
+		return actions;
+	}
+	
+	QStringList UsageStore::ListUnassociated(int count) const {
+		QStringList providers;
+		for (int i = 0 ; i < qMin(count, ranking.count()) ; ++i) {
+			if ((ranking[i]->action == nullptr) && !providers.contains(ranking[i]->provider)) providers << ranking[i]->provider;
+		}
+		
+		return providers;
+	}
+	
+	void UsageStore::Clear() {
+		qDeleteAll(entries);
+		entries.clear();
+		ranking.clear();
+		
+		if (store != nullptr) save_timer.start();
+	}
+	
+	void UsageStore::EnablePersistence(SettingsStore* store, const QString& key) {
+		this->store = store;
+		this->key = key;
+		
+		Deserialize(store->Value(key).toByteArray());
+		
+		// The store syncs itself when the application quits too, but maybe before the last uses are saved in it
+		if (QCoreApplication::instance() != nullptr) {
+			connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &UsageStore::Sync, Qt::UniqueConnection);
+		}
+	}
+	
+	void UsageStore::Sync() {
+		if (store == nullptr) return;
+		
+		if (save_timer.isActive()) Save();
+		store->Sync();
+	}
+	
+	void UsageStore::set_capacity(int capacity) {
+		this->capacity = qMax(1, capacity);
+		UpdateRanking();
+	}
+	
+	void UsageStore::set_half_life(double half_life) {
+		this->half_life = half_life;
+		UpdateRanking();
+	}
+	
+	QString UsageStore::ActionName(const QAction* action) {
+		if (!action->objectName().isEmpty()) return action->objectName();
+		return action->text().remove('&');
+	}
+	
+	double UsageStore::DecayedScore(const Entry* entry, qint64 now) const {
+		const double hours = static_cast<double>(now - entry->last_use) / 3600000.0;
+		return entry->score * std::exp2(-hours / half_life);
+	}
+	
+	void UsageStore::UpdateRanking() {
+		const qint64 now = QDateTime::currentMSecsSinceEpoch();
+		
+		ranking = entries.values();
+		std::sort(ranking.begin(), ranking.end(), [this, now](const Entry* first, const Entry* second) {
+			return DecayedScore(first, now) > DecayedScore(second, now);
+		});
+		
+		// Keep the store bounded
+		while (ranking.count() > capacity) {
+			Entry* entry = ranking.takeLast();
+			entries.remove(entry->provider + '/' + entry->name);
+			delete entry;
+		}
+	}
+	
+	void UsageStore::Save() {
+		save_timer.stop();
+		if (store != nullptr) store->SetValue(key, Serialize());
+	}
+	
+	QByteArray UsageStore::Serialize() const {
+		QByteArray data;
+		QDataStream stream(&data, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_15);
+		
+		stream << static_cast<quint32>(NOVA_USAGE_MAGIC) << static_cast<quint16>(NOVA_USAGE_FORMAT)
+		       << static_cast<quint32>(ranking.count());
+		for (const Entry* i : ranking) {
+			stream << i->provider << i->name << i->score << i->last_use;
+		}
+		
+		return data;
+	}
+	
+	bool UsageStore::Deserialize(const QByteArray& data) {
+		NOVA_TRACE_SCOPE("UsageStore::Deserialize");
+		
+		QDataStream stream(data);
+		stream.setVersion(QDataStream::Qt_5_15);
+		
+		quint32 magic;
+		quint16 format;
+		quint32 count;
+		stream >> magic >> format >> count;
+		if ((stream.status() != QDataStream::Ok) || (magic != NOVA_USAGE_MAGIC) || (format != NOVA_USAGE_FORMAT)) {
+			return false;
+		}
+		
+		for (quint32 i = 0 ; i < count ; ++i) {
+			auto* entry = new Entry{QString(), QString(), 0, 0, nullptr};
+			stream >> entry->provider >> entry->name >> entry->score >> entry->last_use;
+			if (stream.status() != QDataStream::Ok) {
+				delete entry;
+				break;
+			}
+			
+			// Entries recorded in this session are more recent
+			const QString id = entry->provider + '/' + entry->name;
+			if (entries.contains(id)) delete entry;
+			else entries.insert(id, entry);
+		}
+		
+		UpdateRanking();
+		return true;
+	}
+}
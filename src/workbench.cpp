@@ -11,14 +11,21 @@
 	#include <shobjidl_core.h>
 #endif
 
+#include <algorithm>
+
 #include <QtGlobal>
 #include <QtVersionChecks>
 #include <Qt>
 #include <QSize>
-#include <QDateTime>
+#include <QElapsedTimer>
 #include <QKeySequence>
+#include <QEvent>
 #include <QShowEvent>
-#include <QKeyEvent>
+#include <QCloseEvent>
+#include <QByteArray>
+#include <QDataStream>
+#include <QVariant>
+#include <QIODevice>
 #include <QIcon>
 #include <QPixmap>
 #include <QWindow>
@@ -28,6 +35,7 @@
 #include <QApplication>
 #include <QAction>
 #include <QToolBar>
+#include <QDockWidget>
 #include <QWhatsThis>
 #include <QWidget>
 #include <QStatusBar>
@@ -39,9 +47,24 @@
 #include "searchbar.h"
 #include "toolwindow.h"
 #include "settings.h"
+#include "settingsstore.h"
+#include "plugin.h"
+#include "registrationqueue.h"
+#include "idlequeue.h"
+#include "shortcutdispatcher.h"
+#include "usagestore.h"
+#include "searchcontributor.h"
+#include "iconcache.h"
+#include "translations.h"
+#include "trace.h"
 
 #define NOVA_CONTEXT "nova/workbench"
 
+// Header of the layout snapshots
+#define NOVA_LAYOUT_MAGIC 0x4E4C4159  // "NLAY"
+#define NOVA_LAYOUT_FORMAT 1
+#define NOVA_SETTINGS_ACTIONS_KEY "nova/settings_actions"
+
 // Workaround to support Qt5 and Qt6
 #if WIN32
 	#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
@@ -57,14 +80,28 @@ namespace nova {
 	Workbench::Workbench(QWidget* parent):
 			QMainWindow(parent), ProgressMonitor(this), Notifier(),
 			ui(new Ui::Workbench()), menu_tray(nullptr), tool_bar_actions(ActionProvider(NOVA_TR("Tool bar"))),
-			tool_window_actions(NOVA_TR("Tool window")), settings_page_actions(NOVA_TR("Settings")), tray_icon(nullptr) {
+			tool_window_actions(NOVA_TR("Tool window")), settings_page_actions(NOVA_TR("Settings")), tray_icon(nullptr),
+			search_bar_dialog(nullptr), dialog_prewarming(true), startup_budget(4),
+			startup_job_count(0), startup_task(nullptr), is_startup_scheduled(false), is_shown(false),
+			plugin_manager(new PluginManager(this)),
+			registration_queue(new RegistrationQueue(this)), idle_queue(new IdleQueue()),
+			shortcut_dispatcher(new ShortcutDispatcher(this)), usage_store(new UsageStore(this)),
+			layout_store(nullptr), layout_version(0), is_layout_restored(false), is_progress_pending(false),
+			is_notification_pending(false), is_view_initialized(false), avoided_view_updates(0) {
+		NOVA_TRACE_SCOPE("Workbench::Workbench");
+		
 		workbench = this;
-		ui->setupUi(this);
+		{
+			NOVA_TRACE_SCOPE("Workbench::setupUi");
+			ui->setupUi(this);
+		}
 		
 		ui->statusBar->addWidget(ui->wdgNotificationBar, 3);
 		ui->statusBar->addPermanentWidget(ui->wdgProgress, 1);
 		
-		UpdateProgressView(false, nullptr);  // Initialize the progress monitor
+		// Initialize the progress monitor
+		UpdateProgressView(false, nullptr);
+		ApplyViewUpdates();
 
 #ifdef WIN32
 		HRESULT hresult = CoCreateInstance(CLSID_TaskbarList, nullptr, CLSCTX_INPROC_SERVER, IID_ITaskbarList4, reinterpret_cast<void**>(&taskbar));
@@ -81,9 +118,26 @@ namespace nova {
 		RegisterActionProvider(&settings_page_actions);
 		
 		connect(ui->lblNotificationLinks, &QLabel::linkActivated, this, &Workbench::notificationLinkActivated);
+		
+		// Changes are collected, e.g. while a tool window is dragged
+		layout_timer.setSingleShot(true);
+		layout_timer.setInterval(1000);
+		connect(&layout_timer, &QTimer::timeout, this, [this]() { SaveLayout(); });
+		
+		// Bursts of progress and notification changes are applied once per frame
+		view_timer.setSingleShot(true);
+		view_timer.setInterval(16);
+		connect(&view_timer, &QTimer::timeout, this, [this]() { ApplyViewUpdates(); });
 	}
 	
 	Workbench::~Workbench() noexcept {
+		// Contributors might be deleted together with the workbench, e.g. tool windows
+		for (SearchContributor* i : search_contributors) {
+			i->Wait();
+		}
+		
+		delete idle_queue;
+		delete registration_queue;
 		delete ui;
 
 #ifdef WIN32
@@ -98,7 +152,83 @@ namespace nova {
 		dialog.exec();
 	}
 	
+	void Workbench::UnregisterToolWindow(ToolWindow* tool_window) {
+		for (ToolWindowPlaceholder* i : tool_window_placeholders) {
+			if (i->get_tool_window() == tool_window) {
+				UnregisterToolWindow(i);
+				return;
+			}
+		}
+		
+		if (!tool_windows.removeOne(tool_window)) return;
+		
+		UnregisterActionProvider(tool_window);
+		removeDockWidget(tool_window);
+		delete tool_window->navigation_action;
+		delete tool_window;
+	}
+	
+	void Workbench::UnregisterToolWindow(ToolWindowPlaceholder* placeholder) {
+		if (!tool_window_placeholders.removeOne(placeholder)) return;
+		
+		ToolWindow* tool_window = placeholder->get_tool_window();
+		if (tool_window != nullptr) {
+			tool_windows.removeAll(tool_window);
+			UnregisterActionProvider(tool_window);
+			removeDockWidget(tool_window);
+			delete tool_window;
+		}
+		
+		removeDockWidget(placeholder);
+		delete placeholder->navigation_action;
+		delete placeholder;
+	}
+	
+	void Workbench::UnregisterSettingsPage(SettingsPage* settings_page) {
+		if (!settings_pages.removeOne(settings_page)) return;
+		outdated_settings_pages.removeOne(settings_page);
+		
+		UnregisterActionProvider(settings_page);
+		delete settings_page->navigation_action;
+		delete settings_page;
+	}
+	
+	void Workbench::RegisterActionProvider(ActionProvider* provider) {
+		providers << provider;
+		provider->owner = this;
+		shortcut_dispatcher->AddProvider(provider);
+	}
+	
+	void Workbench::UnregisterActionProvider(ActionProvider* provider) {
+		providers.removeAll(provider);
+		if (provider->owner == this) provider->owner = nullptr;
+		shortcut_dispatcher->RemoveProvider(provider);
+		
+		if (auto* contributor = dynamic_cast<SearchContributor*>(provider)) UnregisterSearchContributor(contributor);
+	}
+	
+	void Workbench::RegisterSearchContributor(SearchContributor* contributor) {
+		if (!search_contributors.contains(contributor)) search_contributors << contributor;
+	}
+	
+	void Workbench::UnregisterSearchContributor(SearchContributor* contributor) {
+		// Running searches are cancelled by their time budget
+		if (search_contributors.removeOne(contributor)) contributor->Wait();
+	}
+	
+	ActionProvider* Workbench::FindActionProvider(const QString& title) const {
+		// Menus replace the hotkey character by a space
+		const QString simplified_title = QString(title).remove('&').trimmed();
+		for (ActionProvider* i : providers) {
+			if (QString(i->get_title()).remove('&').trimmed() == simplified_title) return i;
+		}
+		
+		return nullptr;
+	}
+	
 	MenuActionProvider* Workbench::ConstructMenu(const QString& title, bool needs_tool_bar) {
+		NOVA_TRACE_SCOPE("Workbench::ConstructMenu");
+		
 		auto* menu = new MenuActionProvider(this, title, needs_tool_bar);
 		RegisterActionProvider(menu);
 		menuBar()->addMenu(menu);
@@ -109,6 +239,7 @@ namespace nova {
 			
 			menu->ConstructNavigationAction(&tool_bar_actions);
 			addToolBar(tool_bar);
+			RestoreLateLayout(tool_bar);
 		}
 		
 		return menu;
@@ -172,9 +303,10 @@ namespace nova {
 				action = provider->ConstructAction(NOVA_TR("&Search..."));
 				action->setShortcut(QKeySequence("F3"));
 				connect(action, &QAction::triggered, [this]() {
-					SearchBar bar(this);
-					bar.exec();
+					if (search_bar_dialog == nullptr) search_bar_dialog = new SearchBar(this);
+					if (!search_bar_dialog->isVisible()) search_bar_dialog->exec();
 				});
+				shortcut_dispatcher->SetDoubleTapAction(Qt::Key_Shift, action);
 				
 				break;
 			
@@ -188,8 +320,15 @@ namespace nova {
 	
 	void Workbench::AddStatusBarWidget(QWidget* widget, int stretch) {
 		// Guarantee the widget to be inserted in front of the progress indicator
-		static int index = 1;
-		ui->statusBar->insertPermanentWidget(index++, widget, stretch);
+		ui->statusBar->insertPermanentWidget(status_bar_widgets.count() + 1, widget, stretch);
+		status_bar_widgets << widget;
+	}
+	
+	void Workbench::RemoveStatusBarWidget(QWidget* widget) {
+		if (!status_bar_widgets.removeOne(widget)) return;
+		
+		ui->statusBar->removeWidget(widget);
+		delete widget;
 	}
 	
 	QSystemTrayIcon* Workbench::ConstructSystemTrayIcon() {
@@ -207,28 +346,162 @@ namespace nova {
 	}
 	
 	void Workbench::RestoreLayout() {
+		NOVA_TRACE_SCOPE("Workbench::RestoreLayout");
+		
+		// Every call below would relayout and repaint the window, so only the final layout is painted
+		const bool updates_enabled = updatesEnabled();
+		setUpdatesEnabled(false);
+		
 		for (QToolBar* i : findChildren<QToolBar*>(QString(), Qt::FindDirectChildrenOnly)) {
-			// Remove and add the tool bars to reset their layouts
-			removeToolBar(i);
-			
+			// Adding a managed tool bar only moves it, which resets its layout
 			addToolBar(i);
-			i->show();  // Because removeToolBar() hides it
+			if (i->isHidden()) i->show();
 		}
 		
-		for (ToolWindow* i : tool_windows) {
-			i->hide();
-			i->setFloating(false);
-			removeDockWidget(i);
-			addDockWidget(i->default_layout, i);
+		// Rearrange all docks first and resize them afterwards with one call per direction
+		QList<QDockWidget*> shown_docks;
+		QList<QDockWidget*> width_docks;
+		QList<int> widths;
+		QList<QDockWidget*> height_docks;
+		QList<int> heights;
+		
+		const auto rearrange = [this, &shown_docks](QDockWidget* dock_widget, Qt::DockWidgetArea area, bool is_hidden) {
+			if (dock_widget->isFloating()) dock_widget->setFloating(false);
+			removeDockWidget(dock_widget);  // Hides the dock widget
+			addDockWidget(area, dock_widget);
 			
-			// Resize the tool window (Note: the orientation of resizeDocks() specifies if the width or the height should be taken, so it's just swapped)
-			resizeDocks({i}, {i->initial_size}, (i->get_orientation() == Qt::Vertical) ? Qt::Horizontal : Qt::Vertical);
+			if (!is_hidden) shown_docks << dock_widget;
+		};
+		
+		for (ToolWindow* i : tool_windows) {
+			rearrange(i, i->default_layout, i->default_hidden);
 			
-			if (!i->default_hidden) i->show();
+			// The orientation of resizeDocks() specifies if the width or the height should be taken, so it's just swapped
+			if (i->get_orientation() == Qt::Vertical) {
+				width_docks << i;
+				widths << i->initial_size;
+			} else {
+				height_docks << i;
+				heights << i->initial_size;
+			}
 		}
 		
+		for (ToolWindowPlaceholder* i : tool_window_placeholders) {
+			if (i->get_tool_window() == nullptr) rearrange(i, i->default_layout, i->default_hidden);
+		}
+		
+		for (QDockWidget* i : shown_docks) {
+			i->show();
+		}
+		
+		if (!width_docks.isEmpty()) resizeDocks(width_docks, widths, Qt::Horizontal);
+		if (!height_docks.isEmpty()) resizeDocks(height_docks, heights, Qt::Vertical);
+		
 		// Reset the geometry
 		setGeometry(QStyle::alignedRect(Qt::LeftToRight, Qt::AlignCenter, QSize(920, 640), screen()->availableGeometry()));
+		
+		setUpdatesEnabled(updates_enabled);
+		
+		if (is_layout_restored && (layout_store != nullptr)) layout_timer.start();
+	}
+	
+	void Workbench::EnableLayoutPersistence(SettingsStore* store, int version, const QString& key) {
+		layout_store = store;
+		layout_version = version;
+		layout_key = key;
+		
+		// Load the presets
+		const QString preset_prefix = layout_key + "_presets/";
+		const SettingsSnapshot snapshot = layout_store->Snapshot();
+		for (auto i = snapshot.constBegin() ; i != snapshot.constEnd() ; ++i) {
+			if (i.key().startsWith(preset_prefix)) layout_presets.insert(i.key().mid(preset_prefix.length()), i.value().toByteArray());
+		}
+	}
+	
+	QByteArray Workbench::CreateLayoutSnapshot() const {
+		QByteArray snapshot;
+		QDataStream stream(&snapshot, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_15);
+		
+		stream << static_cast<quint32>(NOVA_LAYOUT_MAGIC) << static_cast<quint16>(NOVA_LAYOUT_FORMAT)
+		       << static_cast<qint32>(layout_version) << saveGeometry() << saveState(layout_version);
+		
+		return snapshot;
+	}
+	
+	bool Workbench::ApplyLayoutSnapshot(const QByteArray& snapshot) {
+		NOVA_TRACE_SCOPE("Workbench::ApplyLayoutSnapshot");
+		
+		QDataStream stream(snapshot);
+		stream.setVersion(QDataStream::Qt_5_15);
+		
+		quint32 magic;
+		quint16 format;
+		qint32 version;
+		QByteArray geometry;
+		QByteArray state;
+		stream >> magic >> format >> version >> geometry >> state;
+		
+		if ((stream.status() != QDataStream::Ok) || (magic != NOVA_LAYOUT_MAGIC) || (format != NOVA_LAYOUT_FORMAT)
+		    || (version != layout_version)) {
+			return false;
+		}
+		
+		// Avoid repainting the intermediate layouts
+		const bool updates_enabled = updatesEnabled();
+		setUpdatesEnabled(false);
+		
+		restoreGeometry(geometry);
+		const bool is_restored = restoreState(state, layout_version);
+		
+		setUpdatesEnabled(updates_enabled);
+		return is_restored;
+	}
+	
+	void Workbench::SaveLayoutPreset(const QString& name) {
+		const QByteArray snapshot = CreateLayoutSnapshot();
+		layout_presets.insert(name, snapshot);
+		
+		if (layout_store != nullptr) layout_store->SetValue(layout_key + "_presets/" + name, snapshot);
+	}
+	
+	bool Workbench::ApplyLayoutPreset(const QString& name) {
+		const auto iterator = layout_presets.constFind(name);
+		return (iterator != layout_presets.constEnd()) && ApplyLayoutSnapshot(iterator.value());
+	}
+	
+	void Workbench::RemoveLayoutPreset(const QString& name) {
+		layout_presets.remove(name);
+		if (layout_store != nullptr) layout_store->Remove(layout_key + "_presets/" + name);
+	}
+	
+	void Workbench::TrackLayoutChanges(QWidget* widget) {
+		const auto schedule_save = [this]() {
+			if (is_layout_restored && (layout_store != nullptr)) layout_timer.start();
+		};
+		
+		if (auto* dock_widget = qobject_cast<QDockWidget*>(widget)) {
+			connect(dock_widget, &QDockWidget::dockLocationChanged, this, schedule_save);
+			connect(dock_widget, &QDockWidget::topLevelChanged, this, schedule_save);
+			connect(dock_widget, &QDockWidget::visibilityChanged, this, schedule_save);
+		} else if (auto* tool_bar = qobject_cast<QToolBar*>(widget)) {
+			connect(tool_bar, &QToolBar::topLevelChanged, this, schedule_save);
+			connect(tool_bar, &QToolBar::orientationChanged, this, schedule_save);
+			connect(tool_bar, &QToolBar::visibilityChanged, this, schedule_save);
+		}
+	}
+	
+	void Workbench::SaveLayout() {
+		layout_timer.stop();
+		if (!is_layout_restored || (layout_store == nullptr)) return;
+		
+		layout_store->SetValue(layout_key, CreateLayoutSnapshot());
+		
+		// QMainWindow forgets the positions of missing tool bars, so they're saved separately for RestoreLateLayout()
+		for (QToolBar* i : findChildren<QToolBar*>(QString(), Qt::FindDirectChildrenOnly)) {
+			layout_store->SetValue(layout_key + "_tool_bars/" + i->objectName(),
+			                       QVariantList({static_cast<int>(toolBarArea(i)), !i->isHidden()}));
+		}
 	}
 	
 	void Workbench::showEvent(QShowEvent* event) {
@@ -239,88 +512,305 @@ namespace nova {
 			return;
 		}
 		
+		NOVA_TRACE_SCOPE("Workbench::showEvent");
+		
+		if (!is_shown) {
+			is_shown = true;
+			
+			// The window isn't visible yet, so restoring the layout doesn't flicker. Otherwise, the startup jobs
+			// restore it when the tool windows exist.
+			if (startup_jobs.isEmpty()) {
+				RestorePersistentLayout();
+			} else if (!is_startup_scheduled) {
+				is_startup_scheduled = true;
+				QTimer::singleShot(0, this, [this]() { RunStartupSlice(); });
+			}
+			
+			// Prepare the dialogs after the first frames have been painted and the settings actions are updated
+			if (dialog_prewarming) idle_queue->Post([this]() { PrewarmDialogs(); }, -1, "nova/prewarm_dialogs");
+			
+			// Afterwards, the search bar can propose the actions used in previous sessions
+			const int count = usage_store->get_capacity();
+			idle_queue->Post([this, count]() { AssociateUsedActions(count); }, -1, "nova/associate_used_actions");
+		}
+		
 		// Showing the window might change some settings (e.g. geometry)
+		ScheduleSettingsActions(settings_pages);
+		
+		event->accept();
+	}
+	
+	void Workbench::RestorePersistentLayout() {
+		if (layout_store != nullptr) {
+			for (QDockWidget* i : findChildren<QDockWidget*>(QString(), Qt::FindDirectChildrenOnly)) {
+				TrackLayoutChanges(i);
+			}
+			for (QToolBar* i : findChildren<QToolBar*>(QString(), Qt::FindDirectChildrenOnly)) {
+				TrackLayoutChanges(i);
+			}
+			
+			ApplyLayoutSnapshot(layout_store->Value(layout_key).toByteArray());
+		}
+		
+		is_layout_restored = true;
+	}
+	
+	void Workbench::RestoreLateLayout(QWidget* widget) {
+		// Widgets existing before are restored by RestorePersistentLayout()
+		if (!is_layout_restored || (layout_store == nullptr)) return;
+		
+		TrackLayoutChanges(widget);
+		
+		if (auto* dock_widget = qobject_cast<QDockWidget*>(widget)) {
+			// QMainWindow keeps the positions of dock widgets which were missing when the layout was restored
+			restoreDockWidget(dock_widget);
+		} else if (auto* tool_bar = qobject_cast<QToolBar*>(widget)) {
+			const QVariantList state = layout_store->Value(layout_key + "_tool_bars/" + tool_bar->objectName()).toList();
+			if (state.count() == 2) {
+				addToolBar(static_cast<Qt::ToolBarArea>(state[0].toInt()), tool_bar);
+				tool_bar->setVisible(state[1].toBool());
+			}
+		}
+	}
+	
+	void Workbench::ScheduleStartupJob(const std::function<void()>& job, int priority) {
+		// Behind all jobs with the same or a higher priority
+		auto iterator = std::upper_bound(startup_jobs.begin(), startup_jobs.end(), priority,
+		                                 [](int priority, const StartupJob& job) { return priority > job.priority; });
+		startup_jobs.insert(iterator, {priority, job});
+		++startup_job_count;
+		
+		if (is_shown && !is_startup_scheduled) {
+			is_startup_scheduled = true;
+			QTimer::singleShot(0, this, [this]() { RunStartupSlice(); });
+		}
+	}
+	
+	void Workbench::RunStartupSlice() {
+		NOVA_TRACE_SCOPE("Workbench::RunStartupSlice");
+		
+		is_startup_scheduled = false;
+		if (startup_jobs.isEmpty()) return;
+		
+		if (startup_task == nullptr) {
+			startup_task = new Task(this, NOVA_TR("Starting..."), false);
+			Enable(startup_task);
+		}
+		
+		QElapsedTimer timer;
+		timer.start();
+		do {
+			// Jobs may schedule further jobs
+			const std::function<void()> job = startup_jobs.takeFirst().job;
+			job();
+		} while (!startup_jobs.isEmpty() && (timer.elapsed() < startup_budget));
+		
+		startup_task->set_value(100 * (startup_job_count - startup_jobs.count()) / startup_job_count);
+		
+		if (!startup_jobs.isEmpty()) {
+			is_startup_scheduled = true;
+			QTimer::singleShot(0, this, [this]() { RunStartupSlice(); });
+			return;
+		}
+		
+		Disable(startup_task);
+		delete startup_task;
+		startup_task = nullptr;
+		startup_job_count = 0;
+		
+		if (!is_layout_restored) RestorePersistentLayout();
+	}
+	
+	void Workbench::PrewarmDialogs() {
+		NOVA_TRACE_SCOPE("Workbench::PrewarmDialogs");
+		
+		QuickDialog::Prewarm(this);
+		
+		if ((standard_actions[Action_SearchBar] != nullptr) && (search_bar_dialog == nullptr)) {
+			search_bar_dialog = new SearchBar(this);
+			search_bar_dialog->ensurePolished();
+		}
+	}
+	
+	void Workbench::InvalidateActionStates() {
+		for (ActionProvider* i : providers) {
+			i->InvalidateActionStates();
+		}
+		
+		// Coalesces invalidations, but runs before other idle jobs
+		idle_queue->Post([this]() { UpdateDisplayedActions(); }, 1, "nova/update_actions");
+	}
+	
+	void Workbench::UpdateDisplayedActions() {
+		NOVA_TRACE_SCOPE("Workbench::UpdateDisplayedActions");
+		
+		for (ActionProvider* i : providers) {
+			if (i->is_displayed()) i->UpdateActions();
+		}
+	}
+	
+	void Workbench::ScheduleSettingsActions(const QList<SettingsPage*>& pages) {
+		for (SettingsPage* i : pages) {
+			if (!outdated_settings_pages.contains(i)) outdated_settings_pages << i;
+		}
+		
+		// All pages are updated by one job
+		idle_queue->Post([this]() { FlushSettingsActions(); }, 0, NOVA_SETTINGS_ACTIONS_KEY);
+	}
+	
+	void Workbench::FlushSettingsActions() {
+		idle_queue->Cancel(NOVA_SETTINGS_ACTIONS_KEY);
+		if (outdated_settings_pages.isEmpty()) return;
+		
+		NOVA_TRACE_SCOPE("Workbench::FlushSettingsActions");
+		
 		Properties parameters;
 		parameters["workbench"] = reinterpret_cast<quintptr>(this);
-		for (SettingsPage* i : settings_pages) {
+		for (SettingsPage* i : outdated_settings_pages) {
 			i->RecreateActions(parameters);
 		}
 		
-		event->accept();
+		outdated_settings_pages.clear();
 	}
 	
-	void Workbench::keyPressEvent(QKeyEvent* event) {
-		QMainWindow::keyPressEvent(event);
-		
-		// Double shift shortcut for the search bar action
-		if ((standard_actions[Action_SearchBar] != nullptr) && (event->key() == Qt::Key_Shift)) {
-			static qint64 remaining_time = 0;
+	void Workbench::AssociateUsedActions(int count) {
+		// Only the providers of unassociated entries are searched
+		for (const QString& i : usage_store->ListUnassociated(count)) {
+			const ActionProvider* provider = FindActionProvider(i);
+			if (provider == nullptr) continue;
 			
-			if (QDateTime::currentMSecsSinceEpoch() > remaining_time) {
-				// First click
-				remaining_time = QDateTime::currentMSecsSinceEpoch() + 500;
-			} else {
-				// Second click
-				standard_actions[Action_SearchBar]->trigger();
-				remaining_time = 0;
+			for (QAction* j : provider->ListActions()) {
+				usage_store->Associate(i, j);
 			}
 		}
 	}
 	
+	void Workbench::closeEvent(QCloseEvent* event) {
+		QMainWindow::closeEvent(event);
+		if (!event->isAccepted()) return;
+		
+		// The application might exit without destroying the store
+		SaveLayout();
+		if (layout_store != nullptr) layout_store->Sync();
+		usage_store->Sync();
+	}
+	
+	void Workbench::changeEvent(QEvent* event) {
+		// Before the children are retranslated, which receive the event afterwards
+		if (event->type() == QEvent::LanguageChange) Translations::Invalidate();
+		
+		QMainWindow::changeEvent(event);
+	}
+	
 	void Workbench::UpdateProgressView(bool is_active, const Task* task) {
-		if (!is_active) {
-			ui->lblProgressDescription->setText(NOVA_TR("Ready"));
-			ui->prbProgress->setVisible(false);
+		pending_view.is_progress_active = is_active;
+		if (is_active) {
+			pending_view.progress_text = task->get_task_name() + "...";
+			pending_view.is_indeterminate = task->is_indeterminate();
+			pending_view.progress_value = task->get_value();
+		}
+		
+		if (is_progress_pending) avoided_view_updates++;
+		is_progress_pending = true;
+		if (!view_timer.isActive()) view_timer.start();
+	}
+	
+	void Workbench::UpdateNotificationView(bool is_active, const Notification* notification) {
+		pending_view.is_notification_active = is_active;
+		if (is_active) {
+			pending_view.notification_text = notification->get_title() + ": " + notification->get_message();
+			pending_view.notification_type = notification->get_type();
+			pending_view.notification_links = notification->CreateLinksLabelText();
+		}
+		
+		if (is_notification_pending) avoided_view_updates++;
+		is_notification_pending = true;
+		if (!view_timer.isActive()) view_timer.start();
+	}
+	
+	void Workbench::ApplyViewUpdates() {
+		view_timer.stop();
+		
+		// Only changed properties are set, because each change relayouts the status bar
+		const auto needs_update = [this](bool is_changed) {
+			if (!is_changed && is_view_initialized) avoided_view_updates++;
+			return is_changed || !is_view_initialized;
+		};
+		
+		const ViewState& view = pending_view;
+		
+		if (is_progress_pending) {
+			const bool is_active = view.is_progress_active;
+			const QString text = is_active ? view.progress_text : NOVA_TR_CACHED(Workbench_Ready);
+			const int pb_maximum = view.is_indeterminate ? 0 : 100;  // 0 when the task is indeterminate, else 100%->100
+			
+			if (needs_update(ui->lblProgressDescription->text() != text)) ui->lblProgressDescription->setText(text);
+			if (needs_update(applied_view.is_progress_active != is_active)) ui->prbProgress->setVisible(is_active);
+			
+			if (is_active) {
+				if (needs_update(ui->prbProgress->maximum() != pb_maximum)) ui->prbProgress->setMaximum(pb_maximum);
+				if (needs_update(ui->prbProgress->value() != view.progress_value)) ui->prbProgress->setValue(view.progress_value);
+			}
 			
 #ifdef WIN32
 			if ((taskbar != nullptr) && (windowHandle() != nullptr)) {
 				HWND native_window = reinterpret_cast<HWND>(windowHandle()->winId());
-				taskbar->SetProgressState(native_window, TBPF_NOPROGRESS);
+				if (!is_active) {
+					taskbar->SetProgressState(native_window, TBPF_NOPROGRESS);
+				} else {
+					taskbar->SetProgressState(native_window, (view.is_indeterminate ? TBPF_INDETERMINATE : TBPF_NORMAL));
+					if (!view.is_indeterminate) taskbar->SetProgressValue(native_window, view.progress_value, 100);
+				}
 			}
 #endif
-		} else {
-			// pb_maximum is 0 when the task is indeterminate, else 100%->100
-			const int pb_maximum = task->is_indeterminate() ? 0 : 100;
 			
-			ui->lblProgressDescription->setText(task->get_task_name() + "...");
-			ui->prbProgress->setVisible(true);
-			ui->prbProgress->setMaximum(pb_maximum);
-			ui->prbProgress->setValue(task->get_value());
+			applied_view.is_progress_active = is_active;
+			is_progress_pending = false;
+		}
+		
+		if (is_notification_pending) {
+			const bool is_active = view.is_notification_active;
+			const bool is_type_changed = !applied_view.is_notification_active
+			                             || (applied_view.notification_type != view.notification_type);
 			
+			QIcon icon;
+			if (is_active) {
+				icon = Notification::ConvertToIcon(view.notification_type);
+				
+				if (needs_update(ui->lblNotification->text() != view.notification_text)) {
+					ui->lblNotification->setText(view.notification_text);
+				}
+				if (needs_update(is_type_changed)) ui->lblNotificationIcon->setPixmap(IconCache::Pixmap(icon, QSize(16, 16)));
+				if (needs_update(ui->lblNotificationLinks->text() != view.notification_links)) {
+					ui->lblNotificationLinks->setText(view.notification_links);
+				}
+			}
+
 #ifdef WIN32
-			if ((taskbar != nullptr) && (windowHandle() != nullptr)) {
+			if ((taskbar != nullptr) && (windowHandle() != nullptr) && (is_type_changed || !is_active)) {
 				HWND native_window = reinterpret_cast<HWND>(windowHandle()->winId());
-				taskbar->SetProgressState(native_window, (task->is_indeterminate() ? TBPF_INDETERMINATE : TBPF_NORMAL));
-				if (!task->is_indeterminate()) taskbar->SetProgressValue(native_window, task->get_value(), 100);
+				
+				HICON native_icon = nullptr;
+				if (is_active && !icon.isNull()) {
+					const int icon_size = GetSystemMetrics(SM_CXSMICON);
+					native_icon = qt_pixmapToWinHICON(IconCache::Pixmap(icon, QSize(icon_size, icon_size)));
+				}
+				
+				taskbar->SetOverlayIcon(native_window, native_icon, nullptr);
+				DestroyIcon(native_icon);
 			}
 #endif
-		}
-	}
-	
-	void Workbench::UpdateNotificationView(bool is_active, const Notification* notification) {
-		QIcon icon;
-		if (is_active) {
-			icon = Notification::ConvertToIcon(notification->get_type());
-			ui->lblNotification->setText(notification->get_title() + ": " + notification->get_message());
-			ui->lblNotificationIcon->setPixmap(icon.pixmap(16, 16));
-			ui->lblNotificationLinks->setText(notification->CreateLinksLabelText());
-		}
-
-#ifdef WIN32
-		if ((taskbar != nullptr) && (windowHandle() != nullptr)) {
-			HWND native_window = reinterpret_cast<HWND>(windowHandle()->winId());
 			
-			HICON native_icon = nullptr;
-			if (is_active && !icon.isNull()) {
-				native_icon = qt_pixmapToWinHICON(icon.pixmap(GetSystemMetrics(SM_CXSMICON)));
+			if (needs_update(applied_view.is_notification_active != is_active)) {
+				ui->wdgNotificationBar->setVisible(is_active);
 			}
 			
-			taskbar->SetOverlayIcon(native_window, native_icon, nullptr);
-			DestroyIcon(native_icon);
+			applied_view.is_notification_active = is_active;
+			applied_view.notification_type = view.notification_type;
+			is_notification_pending = false;
 		}
-#endif
 		
-		ui->wdgNotificationBar->setVisible(is_active);
+		is_view_initialized = true;
 	}
 	
 	void Workbench::ShowNotificationPopup(const Notification* notification) {
@@ -27,12 +27,16 @@
 #include <workbench.h>
 #include <toolwindow.h>
 #include <settings.h>
+#include <settingsstore.h>
 #include <quickdialog.h>
 #include <actionprovider.h>
 #include <progress.h>
 #include <notification.h>
+#include <plugin.h>
+#include <usagestore.h>
+#include <searchcontributor.h>
 
-QSettings settings("these are", "test settings");
+nova::SettingsStore* settings_store;
 
 class TestToolWindow : public nova::ToolWindow {
 	public:
@@ -56,6 +60,14 @@ class TestToolWindow : public nova::ToolWindow {
 		}
 };
 
+class TestLazyToolWindow : public nova::ToolWindow {
+	public:
+		inline explicit TestLazyToolWindow(QWidget* parent):
+				nova::ToolWindow(parent, "My Lazy Tool Window", Qt::Horizontal, false, Qt::NoDockWidgetArea) {
+			set_content_widget(new QTextEdit("Created on first show", this));
+		}
+};
+
 class TestSettingsPage : public nova::SettingsPage {
 	public:
 		inline explicit TestSettingsPage(QObject* parent):
@@ -84,19 +96,19 @@ class TestSettingsPage : public nova::SettingsPage {
 		}
 		
 		inline void RestoreDefaults() override {
-			settings.setValue("edit_1", "My string");
-			settings.setValue("edit_2", true);
+			settings_store->SetValue("edit_1", "My string");
+			settings_store->SetValue("edit_2", true);
 		}
 	
 	protected:
 		inline void LoadSettings() override {
-			edit_1->setText(settings.value("edit_1").toString());
-			edit_2->setChecked(settings.value("edit_2").toBool());
+			edit_1->setText(settings_store->Value("edit_1").toString());
+			edit_2->setChecked(settings_store->Value("edit_2").toBool());
 		}
 		
 		inline void Apply() override {
-			settings.setValue("edit_1", edit_1->text());
-			settings.setValue("edit_2", edit_2->isChecked());
+			settings_store->SetValue("edit_1", edit_1->text());
+			settings_store->SetValue("edit_2", edit_2->isChecked());
 		}
 	
 	private:
@@ -104,12 +116,61 @@ class TestSettingsPage : public nova::SettingsPage {
 		QCheckBox* edit_2;
 };
 
+// Settings page without hand-written load and apply code
+class TestBoundSettingsPage : public nova::SettingsPage {
+	public:
+		inline explicit TestBoundSettingsPage(QObject* parent):
+				nova::SettingsPage(parent, "My Bound Settings Page") {
+			auto* root_widget = new QWidget();
+			auto* root_layout = new QVBoxLayout(root_widget);
+			
+			auto* edit = new QLineEdit(root_widget);
+			edit->setPlaceholderText("Bound string setting");
+			edit->setProperty("nova/setting", "Bound string setting");
+			
+			auto* check_box = new QCheckBox(root_widget);
+			check_box->setText("Bound bool setting");
+			check_box->setProperty("nova/setting", true);
+			
+			root_layout->addWidget(edit);
+			root_layout->addWidget(check_box);
+			root_layout->addItem(new QSpacerItem(0, 0, QSizePolicy::Minimum, QSizePolicy::Expanding));
+			set_content_widget(root_widget);
+			
+			set_settings_store(settings_store);
+			BindSetting(edit, "bound/edit", "My bound string");
+			BindSetting(check_box, "bound/check_box", false);
+		}
+};
+
+// Search results other than actions, found on a worker thread
+class TestSettingsContributor : public nova::SearchContributor {
+	public:
+		inline TestSettingsContributor():
+				nova::SearchContributor("Settings Values") {}
+	
+	protected:
+		inline void Search(nova::SearchQuery& query) override {
+			const nova::SettingsSnapshot snapshot = settings_store->Snapshot();  // Can be read on any thread
+			for (auto i = snapshot.constBegin() ; i != snapshot.constEnd() ; ++i) {
+				if (query.is_cancelled()) return;
+				if (i.key().startsWith("nova/")) continue;  // Serialized data
+				
+				const QString text = i.key() + " = " + i.value().toString();
+				const double score = query.Rate(text);
+				if (score > 0) query.Report({text, QString(), QString(), QString(), score, []() { nova::workbench->OpenSettings(); }});
+			}
+		}
+};
+
 class Workbench : public nova::Workbench {
 	public:
 		inline Workbench():
 				nova::Workbench() {
 			RegisterToolWindow<TestToolWindow>();
+			RegisterLazyToolWindow<TestLazyToolWindow>("My Lazy Tool Window", Qt::Horizontal, Qt::NoDockWidgetArea, 30000);
 			RegisterSettingsPage<TestSettingsPage>();
+			RegisterSettingsPage<TestBoundSettingsPage>();
 			
 			// Status bar
 			AddStatusBarWidget(new QLabel("Label 1", this), 2);
@@ -189,8 +250,18 @@ class Workbench : public nova::Workbench {
 				dialog.exec();
 			});
 			
+			// QuickDialog demo 3 (large lists are evaluated lazily)
+			QAction* symbol_action = sub_menu->ConstructAction("&Symbol Demo");
+			connect(symbol_action, &QAction::triggered, [this]() {
+				const int index = nova::QuickDialog::InputItemIndex(this, "Go to Symbol", 50000, [](int index) {
+					return QString("symbol_%1()").arg(index);
+				});
+				if (index != -1) ShowNotification("Symbol", QString("symbol_%1() selected").arg(index));
+			});
+			
 			menu_help->ShowMenu(sub_menu);
 			sub_menu->ShowAction(help_action);
+			sub_menu->ShowAction(symbol_action);
 			
 			// Actions can also be added to groups when the group is already shown (useful for plugins)
 			group_help->AddAction(menu_help->ConstructAction("Plugin Action"));
@@ -212,13 +283,51 @@ class Workbench : public nova::Workbench {
 			
 			task1->start();
 			task2->start();
+			
+			EnableLayoutPersistence(settings_store);
+			get_usage_store()->EnablePersistence(settings_store);  // Proposals of the search bar
+			
+			// Plugins are initialized in parallel and activated afterwards, the lazy demo plugin is loaded by its action.
+			// Loading them after the window has been painted the first time lets it appear sooner.
+			ScheduleStartupJob([this]() {
+				get_plugin_manager()->LoadPlugins(QApplication::applicationDirPath() + "/plugins");
+			});
+			
+			// Hot reload, e.g. after rebuilding the plugin
+			QAction* reload_action = menu_help->ConstructAction("Reload Demo Plugin");
+			menu_help->ShowAction(reload_action);
+			connect(reload_action, &QAction::triggered, [this]() {
+				if (!get_plugin_manager()->ReloadPlugin("Demo Plugin")) ShowNotification("Demo Plugin", "The plugin isn't loaded.");
+			});
+			
+			// Action update demo
+			menu_help->SetUpdateCallback(reload_action, [this](QAction* action) {
+				action->setEnabled(get_plugin_manager()->is_active("Demo Plugin"));
+			});
+			connect(get_plugin_manager(), &nova::PluginManager::pluginActivated, this, &Workbench::InvalidateActionStates);
+			connect(get_plugin_manager(), &nova::PluginManager::pluginUnloaded, this, &Workbench::InvalidateActionStates);
+			
+			RegisterSearchContributor(&settings_contributor);
 		}
+		
+		inline ~Workbench() noexcept override {
+			UnregisterSearchContributor(&settings_contributor);  // Before it's deleted
+		}
+	
+	private:
+		TestSettingsContributor settings_contributor;
 };
 
 int main(int argc, char** argv) {
 	new QApplication(argc, argv);
 	QApplication::setWindowIcon(QApplication::style()->standardIcon(QStyle::SP_MediaPlay));
 	
+	{
+		// Only locates the file, the store is its only writer
+		const QSettings settings("these are", "test settings");
+		settings_store = new nova::SettingsStore(settings.fileName(), settings.format(), qApp);
+	}
+	
 	Workbench workbench;
 	workbench.show();
 	
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2021 by Jannik Alber.
+ * All rights reserved.
+ */
+
+#include <QObject>
+#include <QThread>
+#include <QAction>
+#include <QLabel>
+
+#include <workbench.h>
+#include <plugin.h>
+
+// Loaded by NovaDemo from the directory "plugins" next to the executable
+class DemoPlugin : public QObject, public nova::Plugin {
+	Q_OBJECT
+	Q_PLUGIN_METADATA(IID NOVA_PLUGIN_IID)
+	Q_INTERFACES(nova::Plugin)
+	
+	public:
+		bool Initialize() override {
+			// Simulates expensive preparations on a worker thread. Independent plugins are prepared in parallel,
+			// and triggering the lazy plugin's action prepares it in the background without blocking the GUI thread.
+			QThread::msleep(500);
+			return true;
+		}
+		
+		void Activate(nova::Workbench* window) override {
+			window->ShowNotification("Demo Plugin", "The demo plugin has been activated.");
+			
+			// Declared by the manifest, so it's shown before the plugin is loaded
+			QAction* action = window->get_plugin_manager()->get_action("demoplugin.hello");
+			connect(action, &QAction::triggered, this, [window]() {
+				window->ShowNotification("Demo Plugin", "Hello!");
+			});
+			
+			// Removed automatically when the plugin is unloaded
+			window->AddStatusBarWidget(new QLabel("Demo Plugin"), 0);
+		}
+};
+
+#include "novademoplugin.moc"